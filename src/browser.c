@@ -23,6 +23,8 @@
 #include <glib/gi18n.h>
 #include <gdk/gdkkeysyms.h>
 
+#include <string.h>
+
 typedef struct {
   GtkWidget *win;
   GtkWidget *image;
@@ -31,12 +33,44 @@ typedef struct {
   GtkWidget *lfile;
   GtkWidget *cat_list;
   GtkWidget *icon_list;
+  GtkWidget *search;
 
   GtkIconTheme *theme;
+  gint icon_size;
 
   GHashTable *icons;
+  GtkListStore *cat_store;
+
+  /* names of all icons for search */
+  GPtrArray *index;
+  GHashTable *index_set;
+  GList *index_ctx;
+  gchar *search_key;
+  GPtrArray *hits;
+
+  /* rendered icons shared between categories */
+  GHashTable *pixbufs;          /* name => GList link in lru */
+  GQueue *lru;
+  GHashTable *pending;
+  GThreadPool *loader;
+  guint seq;
 } IconBrowserData;
 
+#define PIXBUF_CACHE_SIZE 1024
+
+typedef struct {
+  gchar *name;
+  GdkPixbuf *pixbuf;
+} CachedIcon;
+
+typedef struct {
+  IconBrowserData *data;
+  gchar *name;
+  gchar *file;
+  guint seq;
+  GdkPixbuf *pixbuf;
+} IconJob;
+
 static gboolean show_regular = TRUE;
 static gboolean show_symbolic = FALSE;
 
@@ -51,66 +85,181 @@ key_press_cb (GtkWidget * w, GdkEventKey * ev, gpointer data)
   return FALSE;
 }
 
-static GtkListStore *
-load_icon_cat (IconBrowserData * data, gchar * cat)
+static void
+cache_icon (IconBrowserData *data, const gchar *name, GdkPixbuf *pb)
 {
-  GtkListStore *store;
-  GList *i, *icons;
-  gint size, w, h;
+  CachedIcon *ci;
+
+  ci = g_new0 (CachedIcon, 1);
+  ci->name = g_strdup (name);
+  ci->pixbuf = pb ? g_object_ref (pb) : NULL;
+  g_queue_push_head (data->lru, ci);
+  g_hash_table_insert (data->pixbufs, ci->name, data->lru->head);
 
-  gtk_icon_size_lookup (GTK_ICON_SIZE_MENU, &w, &h);
-  size = MIN (w, h);
+  /* drop least recently used icons */
+  while (g_queue_get_length (data->lru) > PIXBUF_CACHE_SIZE)
+    {
+      ci = g_queue_pop_tail (data->lru);
+      g_hash_table_remove (data->pixbufs, ci->name);
+      g_free (ci->name);
+      if (ci->pixbuf)
+        g_object_unref (ci->pixbuf);
+      g_free (ci);
+    }
+}
 
-  store = gtk_list_store_new (2, GDK_TYPE_PIXBUF, G_TYPE_STRING);
+static gboolean
+icon_loaded_cb (gpointer d)
+{
+  IconJob *job = (IconJob *) d;
 
-  icons = gtk_icon_theme_list_icons (data->theme, cat);
-  for (i = icons; i; i = i->next)
+  g_hash_table_remove (job->data->pending, job->name);
+  cache_icon (job->data, job->name, job->pixbuf);
+  gtk_widget_queue_draw (job->data->icon_list);
+
+  g_free (job->name);
+  g_free (job->file);
+  if (job->pixbuf)
+    g_object_unref (job->pixbuf);
+  g_free (job);
+
+  return FALSE;
+}
+
+/* decode icon file in loader thread */
+static void
+load_icon_func (gpointer d, gpointer user_data)
+{
+  IconJob *job = (IconJob *) d;
+  gint size = job->data->icon_size;
+  GdkPixbuf *pb;
+
+  pb = gdk_pixbuf_new_from_file_at_size (job->file, size, size, NULL);
+  if (pb && (gdk_pixbuf_get_width (pb) > size || gdk_pixbuf_get_height (pb) > size))
     {
-      GtkTreeIter iter;
-      GdkPixbuf *pb, *spb;
-#if GTK_CHECK_VERSION(3,0,0)
-      GtkIconInfo *info;
+      job->pixbuf = gdk_pixbuf_scale_simple (pb, size, size, GDK_INTERP_BILINEAR);
+      g_object_unref (pb);
+    }
+  else
+    job->pixbuf = pb;
 
-      info = gtk_icon_theme_lookup_icon (data->theme, i->data, size, 0);
-      if (gtk_icon_info_is_symbolic (info))
-        {
-          if (!show_symbolic)
-            continue;
-        }
-      else
-        {
-          if (!show_regular)
-            continue;
-        }
-      g_object_unref (info);
+  g_idle_add (icon_loaded_cb, job);
+}
+
+/* latest requests first, they are for currently visible rows */
+static gint
+job_sort_func (gconstpointer a, gconstpointer b, gpointer d)
+{
+  const IconJob *ja = a, *jb = b;
+
+  if (ja->seq == jb->seq)
+    return 0;
+  return ja->seq > jb->seq ? -1 : 1;
+}
+
+static void
+request_icon (IconBrowserData *data, const gchar *name)
+{
+  GtkIconInfo *info;
+  const gchar *file;
 
-      spb = pb = gtk_icon_theme_load_icon (data->theme, i->data, size, 0, NULL);
+  if (g_hash_table_lookup (data->pending, name))
+    return;
+
+#if GTK_CHECK_VERSION(3,0,0)
+  info = gtk_icon_theme_lookup_icon (data->theme, name, data->icon_size, 0);
 #else
-      /* GTK+-2 can't discriminate symbolic icons */
-      spb = pb = gtk_icon_theme_load_icon (data->theme, i->data, size, GTK_ICON_LOOKUP_GENERIC_FALLBACK, NULL);
+  info = gtk_icon_theme_lookup_icon (data->theme, name, data->icon_size, GTK_ICON_LOOKUP_GENERIC_FALLBACK);
 #endif
+  file = info ? gtk_icon_info_get_filename (info) : NULL;
 
-      if (pb)
-        {
-          /* scale pixbuf if needed */
-          w = gdk_pixbuf_get_width (pb);
-          h = gdk_pixbuf_get_height (pb);
-          if (w > size || h > size)
-            {
-              pb = gdk_pixbuf_scale_simple (spb, size, size, GDK_INTERP_BILINEAR);
-              g_object_unref (spb);
-            }
-        }
-
-      gtk_list_store_append (store, &iter);
-      gtk_list_store_set (store, &iter, 0, pb, 1, i->data, -1);
+  if (file)
+    {
+      IconJob *job = g_new0 (IconJob, 1);
+
+      job->data = data;
+      job->name = g_strdup (name);
+      job->file = g_strdup (file);
+      job->seq = ++data->seq;
+      g_hash_table_insert (data->pending, g_strdup (name), GINT_TO_POINTER (TRUE));
+      g_thread_pool_push (data->loader, job, NULL);
+    }
+  else
+    {
+      /* built-in icon or nothing */
+      GdkPixbuf *pb = info ? gtk_icon_info_load_icon (info, NULL) : NULL;
 
+      cache_icon (data, name, pb);
       if (pb)
         g_object_unref (pb);
     }
+
+  if (info)
+#if !GTK_CHECK_VERSION(3,0,0)
+    gtk_icon_info_free (info);
+#else
+    g_object_unref (info);
+#endif
+}
+
+/* called for visible rows only */
+static void
+icon_data_func (GtkTreeViewColumn *col, GtkCellRenderer *r, GtkTreeModel *m, GtkTreeIter *iter, gpointer d)
+{
+  IconBrowserData *data = (IconBrowserData *) d;
+  GList *link;
+  gchar *name;
+
+  gtk_tree_model_get (m, iter, 0, &name, -1);
+
+  link = g_hash_table_lookup (data->pixbufs, name);
+  if (link)
+    {
+      /* move to the top of lru list */
+      g_queue_unlink (data->lru, link);
+      g_queue_push_head_link (data->lru, link);
+      g_object_set (r, "pixbuf", ((CachedIcon *) link->data)->pixbuf, NULL);
+    }
+  else
+    {
+      g_object_set (r, "pixbuf", NULL, NULL);
+      request_icon (data, name);
+    }
+
+  g_free (name);
+}
+
+static gboolean
+show_icon (gchar *name)
+{
+#if GTK_CHECK_VERSION(3,0,0)
+  /* names are enough here, symbolic icons are named accordingly */
+  if (g_str_has_suffix (name, "-symbolic"))
+    return show_symbolic;
+  else
+    return show_regular;
+#else
+  return TRUE;
+#endif
+}
+
+static GtkListStore *
+load_icon_cat (IconBrowserData * data, gchar * cat)
+{
+  GtkListStore *store;
+  GList *i, *icons;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+
+  icons = gtk_icon_theme_list_icons (data->theme, cat);
+  for (i = icons; i; i = i->next)
+    {
+      if (show_icon (i->data))
+        gtk_list_store_insert_with_values (store, NULL, -1, 0, i->data, -1);
+    }
   g_list_free_full (icons, g_free);
 
-  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store), 1, GTK_SORT_ASCENDING);
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store), 0, GTK_SORT_ASCENDING);
 
   return store;
 }
@@ -124,7 +273,7 @@ print_icon (GtkTreeView *tv, GtkTreePath *path, GtkTreeViewColumn *col, IconBrow
 
   model = gtk_tree_view_get_model (tv);
   gtk_tree_model_get_iter (model, &iter, path);
-  gtk_tree_model_get (model, &iter, 1, &icon, -1);
+  gtk_tree_model_get (model, &iter, 0, &icon, -1);
 
   g_print ("%s\n", icon);
 
@@ -144,7 +293,7 @@ select_icon (GtkTreeSelection * sel, IconBrowserData * data)
   if (!gtk_tree_selection_get_selected (sel, &model, &iter))
     return;
 
-  gtk_tree_model_get (model, &iter, 1, &icon, -1);
+  gtk_tree_model_get (model, &iter, 0, &icon, -1);
 
   gtk_image_set_from_icon_name (GTK_IMAGE (data->image), icon, GTK_ICON_SIZE_DIALOG);
 
@@ -203,7 +352,122 @@ select_cat (GtkTreeSelection * sel, IconBrowserData * data)
       store = load_icon_cat (data, cat);
       g_hash_table_insert (data->icons, cat, store);
     }
+  else
+    g_free (cat);
+  data->cat_store = store;
+
+  /* leave search mode */
+  if (data->search_key)
+    gtk_entry_set_text (GTK_ENTRY (data->search), "");
+  else
+    gtk_tree_view_set_model (GTK_TREE_VIEW (data->icon_list), GTK_TREE_MODEL (store));
+}
+
+static gint
+cmp_names (gconstpointer a, gconstpointer b)
+{
+  return strcmp (*(gchar **) a, *(gchar **) b);
+}
+
+static void
+show_hits (IconBrowserData *data)
+{
+  GtkListStore *store;
+  guint i;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  for (i = 0; i < data->hits->len; i++)
+    gtk_list_store_insert_with_values (store, NULL, -1, 0, g_ptr_array_index (data->hits, i), -1);
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store), 0, GTK_SORT_ASCENDING);
+
   gtk_tree_view_set_model (GTK_TREE_VIEW (data->icon_list), GTK_TREE_MODEL (store));
+  g_object_unref (store);
+}
+
+static void
+search_icons (IconBrowserData *data, gboolean full)
+{
+  GPtrArray *from, *hits;
+  gchar *key;
+  guint i;
+
+  key = g_ascii_strdown (gtk_entry_get_text (GTK_ENTRY (data->search)), -1);
+  g_strstrip (key);
+
+  if (!key[0])
+    {
+      /* back to category */
+      g_free (key);
+      g_free (data->search_key);
+      data->search_key = NULL;
+      gtk_tree_view_set_model (GTK_TREE_VIEW (data->icon_list), GTK_TREE_MODEL (data->cat_store));
+      return;
+    }
+
+  /* narrow previous results when key grows */
+  if (!full && data->search_key && strstr (key, data->search_key))
+    from = data->hits;
+  else
+    from = data->index;
+
+  hits = g_ptr_array_new ();
+  for (i = 0; i < from->len; i++)
+    {
+      gchar *name = g_ptr_array_index (from, i);
+      if (strstr (name, key))
+        g_ptr_array_add (hits, name);
+    }
+
+  if (data->hits)
+    g_ptr_array_free (data->hits, TRUE);
+  data->hits = hits;
+  g_free (data->search_key);
+  data->search_key = key;
+
+  show_hits (data);
+}
+
+static void
+search_changed_cb (GtkEntry *e, IconBrowserData *data)
+{
+  search_icons (data, FALSE);
+}
+
+/* add icons of one context to search index */
+static gboolean
+build_index (gpointer d)
+{
+  IconBrowserData *data = (IconBrowserData *) d;
+  GList *i, *icons;
+  gchar *ctx;
+
+  if (!data->index_ctx)
+    {
+      g_ptr_array_sort (data->index, cmp_names);
+      /* update results with complete index */
+      if (data->search_key)
+        search_icons (data, TRUE);
+      return FALSE;
+    }
+
+  ctx = data->index_ctx->data;
+  data->index_ctx = g_list_delete_link (data->index_ctx, data->index_ctx);
+
+  icons = gtk_icon_theme_list_icons (data->theme, ctx);
+  for (i = icons; i; i = i->next)
+    {
+      if (!show_icon (i->data) || g_hash_table_lookup (data->index_set, i->data))
+        {
+          g_free (i->data);
+          continue;
+        }
+      g_hash_table_insert (data->index_set, i->data, i->data);
+      g_ptr_array_add (data->index, i->data);
+    }
+  g_list_free (icons);
+  g_free (ctx);
+
+  return TRUE;
 }
 
 gint
@@ -218,6 +482,7 @@ main (gint argc, gchar * argv[])
   GtkCellRenderer *r;
   GtkWidget *w, *p, *box, *t;
   gboolean ver = FALSE;
+  gint iw, ih;
   gboolean all = FALSE, symbolic = FALSE, interactive = FALSE;
 
   GError *err = NULL;
@@ -278,6 +543,15 @@ main (gint argc, gchar * argv[])
       gtk_icon_theme_set_custom_theme (data->theme, themes[0]);
     }
 
+  /* setup icons loader */
+  gtk_icon_size_lookup (GTK_ICON_SIZE_MENU, &iw, &ih);
+  data->icon_size = MIN (iw, ih);
+  data->pixbufs = g_hash_table_new (g_str_hash, g_str_equal);
+  data->lru = g_queue_new ();
+  data->pending = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  data->loader = g_thread_pool_new (load_icon_func, NULL, 2, FALSE, NULL);
+  g_thread_pool_set_sort_function (data->loader, job_sort_func, NULL);
+
   /* create interface */
   data->win = gtk_window_new (GTK_WINDOW_TOPLEVEL);
   gtk_window_set_title (GTK_WINDOW (data->win), _("Icon browser"));
@@ -403,7 +677,7 @@ main (gint argc, gchar * argv[])
   gtk_tree_view_append_column (GTK_TREE_VIEW (data->cat_list), col);
 
   /* load icons category */
-  data->icons = g_hash_table_new (g_direct_hash, g_direct_equal);
+  data->icons = g_hash_table_new (g_str_hash, g_str_equal);
   icat = gtk_icon_theme_list_contexts (data->theme);
   for (ic = icat; ic; ic = ic->next)
     {
@@ -411,15 +685,35 @@ main (gint argc, gchar * argv[])
 
       gtk_list_store_append (store, &iter);
       gtk_list_store_set (store, &iter, 0, ic->data, -1);
-      g_free (ic->data);
     }
-  g_list_free (icat);
+
+  /* build search index in background, context by context */
+  data->index = g_ptr_array_new ();
+  data->index_set = g_hash_table_new (g_str_hash, g_str_equal);
+  data->index_ctx = icat;
+  g_idle_add (build_index, data);
 
   /* create icons list */
+#if !GTK_CHECK_VERSION(3,0,0)
+  box = gtk_vbox_new (FALSE, 2);
+#else
+  box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 2);
+#endif
+  gtk_paned_add2 (GTK_PANED (p), box);
+
+#if GTK_CHECK_VERSION(3,6,0)
+  data->search = gtk_search_entry_new ();
+#else
+  data->search = gtk_entry_new ();
+#endif
+  gtk_widget_set_tooltip_text (data->search, _("Search icons in all categories"));
+  g_signal_connect (G_OBJECT (data->search), "changed", G_CALLBACK (search_changed_cb), data);
+  gtk_box_pack_start (GTK_BOX (box), data->search, FALSE, FALSE, 0);
+
   w = gtk_scrolled_window_new (NULL, NULL);
   gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (w), GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
   gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (w), GTK_SHADOW_ETCHED_IN);
-  gtk_paned_add2 (GTK_PANED (p), w);
+  gtk_box_pack_start (GTK_BOX (box), w, TRUE, TRUE, 0);
 
   data->icon_list = gtk_tree_view_new ();
   gtk_tree_view_set_headers_visible (GTK_TREE_VIEW (data->icon_list), TRUE);
@@ -436,15 +730,19 @@ main (gint argc, gchar * argv[])
 
   col = gtk_tree_view_column_new ();
   gtk_tree_view_column_set_title (col, _("Icons"));
-  gtk_tree_view_column_set_sort_column_id (col, 1);
+  gtk_tree_view_column_set_sort_column_id (col, 0);
   r = gtk_cell_renderer_pixbuf_new ();
+  gtk_cell_renderer_set_fixed_size (r, data->icon_size, data->icon_size);
   gtk_tree_view_column_pack_start (col, r, FALSE);
-  gtk_tree_view_column_set_attributes (col, r, "pixbuf", 0, NULL);
+  gtk_tree_view_column_set_cell_data_func (col, r, icon_data_func, data, NULL);
   r = gtk_cell_renderer_text_new ();
   gtk_tree_view_column_pack_start (col, r, FALSE);
-  gtk_tree_view_column_set_attributes (col, r, "text", 1, NULL);
+  gtk_tree_view_column_set_attributes (col, r, "text", 0, NULL);
   gtk_tree_view_column_set_expand (col, TRUE);
+  /* rows have same height, so only visible ones are rendered */
+  gtk_tree_view_column_set_sizing (col, GTK_TREE_VIEW_COLUMN_FIXED);
   gtk_tree_view_append_column (GTK_TREE_VIEW (data->icon_list), col);
+  gtk_tree_view_set_fixed_height_mode (GTK_TREE_VIEW (data->icon_list), TRUE);
 
   gtk_widget_show_all (data->win);
 
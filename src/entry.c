@@ -17,11 +17,23 @@
  * Copyright (C) 2008-2019, Victor Ananjevsky <ananasik@gmail.com>
  */
 
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+
 #include "yad.h"
 
+#define COMPLETION_BATCH 1000
+#define COMPLETION_FLUSH_TIME 100      /* in milliseconds */
+
 static GtkWidget *entry;
 static gboolean is_combo = FALSE;
 
+G_LOCK_DEFINE_STATIC (completion_lock);
+static GPtrArray *completion_values = NULL;
+static guint completion_flush_id = 0;
+static gboolean completion_done = FALSE;
+
 static void
 entry_activate_cb (GtkEntry * entry, gpointer data)
 {
@@ -84,26 +96,138 @@ icon_cb (GtkEntry * entry, GtkEntryIconPosition pos, GdkEventButton * event, gpo
     }
 }
 
+/* add values read by completion thread to the model */
+static void
+flush_completion (GtkTreeModel *model)
+{
+  GPtrArray *values;
+  guint i;
+
+  G_LOCK (completion_lock);
+  values = completion_values;
+  completion_values = g_ptr_array_new_with_free_func (g_free);
+  G_UNLOCK (completion_lock);
+
+  for (i = 0; i < values->len; i++)
+    completion_model_add (model, g_ptr_array_index (values, i));
+  g_ptr_array_free (values, TRUE);
+}
+
+static gboolean
+completion_idle_cb (gpointer data)
+{
+  G_LOCK (completion_lock);
+  completion_flush_id = 0;
+  G_UNLOCK (completion_lock);
+
+  flush_completion (GTK_TREE_MODEL (data));
+
+  return FALSE;
+}
+
+static gboolean
+completion_timeout_cb (gpointer data)
+{
+  gboolean done;
+  guint id = 0;
+
+  G_LOCK (completion_lock);
+  done = completion_done;
+  if (done)
+    {
+      id = completion_flush_id;
+      completion_flush_id = 0;
+    }
+  G_UNLOCK (completion_lock);
+
+  if (id)
+    g_source_remove (id);
+
+  flush_completion (GTK_TREE_MODEL (data));
+
+  if (done)
+    {
+      /* model must be released in main thread */
+      g_object_unref (G_OBJECT (data));
+      return FALSE;
+    }
+  return TRUE;
+}
+
+/* read completion values in background. values are passed to main loop
+ * when batch is full or by timeout, so slow producer is shown in time */
+static gpointer
+read_completion_thread (gpointer data)
+{
+  GtkTreeModel *model = GTK_TREE_MODEL (data);
+  FILE *f;
+  gchar *line = NULL;
+  size_t size = 0;
+  ssize_t len;
+
+  if (options.entry_data.completion_cmd)
+    f = popen (options.entry_data.completion_cmd, "r");
+  else if (strcmp (options.entry_data.completion_file, "-") == 0)
+    f = stdin;
+  else
+    f = fopen (options.entry_data.completion_file, "r");
+
+  if (!f)
+    g_printerr (_("Cannot read completion values: %s\n"), g_strerror (errno));
+
+  while (f && (len = getline (&line, &size, f)) != -1)
+    {
+      if (len > 0 && line[len - 1] == '\n')
+        line[--len] = '\0';
+      if (len == 0)
+        continue;
+
+      G_LOCK (completion_lock);
+      g_ptr_array_add (completion_values, g_strdup (line));
+      if (completion_values->len >= COMPLETION_BATCH && completion_flush_id == 0)
+        completion_flush_id = g_idle_add (completion_idle_cb, model);
+      G_UNLOCK (completion_lock);
+    }
+  free (line);
+
+  if (options.entry_data.completion_cmd && f)
+    pclose (f);
+  else if (f && f != stdin)
+    fclose (f);
+
+  G_LOCK (completion_lock);
+  completion_done = TRUE;
+  G_UNLOCK (completion_lock);
+
+  return NULL;
+}
+
 static GtkTreeModel *
 create_completion_model (void)
 {
-  GtkListStore *store;
-  GtkTreeIter iter;
+  GtkTreeModel *model;
   gint i = 0;
 
-  store = gtk_list_store_new (1, G_TYPE_STRING);
+  model = completion_model_new ();
 
   if (options.extra_data)
     {
       while (options.extra_data[i] != NULL)
         {
-          gtk_list_store_append (store, &iter);
-          gtk_list_store_set (store, &iter, 0, options.extra_data[i], -1);
+          completion_model_add (model, options.extra_data[i]);
           i++;
         }
     }
 
-  return GTK_TREE_MODEL (store);
+  if (options.entry_data.completion_file || options.entry_data.completion_cmd)
+    {
+      completion_values = g_ptr_array_new_with_free_func (g_free);
+      /* timeout holds the model until all values are read */
+      g_timeout_add (COMPLETION_FLUSH_TIME, completion_timeout_cb, g_object_ref (model));
+      g_thread_unref (g_thread_new ("completion", read_completion_thread, model));
+    }
+
+  return model;
 }
 
 GtkWidget *
@@ -188,7 +312,7 @@ entry_create_widget (GtkWidget * dlg)
 
       gtk_spin_button_set_value (GTK_SPIN_BUTTON (c), val);
     }
-  else if (!options.entry_data.completion && options.extra_data && *options.extra_data)
+  else if (!options.entry_data.completion && !options.entry_data.completion_file && !options.entry_data.completion_cmd && options.extra_data && *options.extra_data)
     {
       gint active, i;
 
@@ -252,7 +376,7 @@ entry_create_widget (GtkWidget * dlg)
       if (options.common_data.hide_text)
         g_object_set (G_OBJECT (entry), "visibility", FALSE, NULL);
 
-      if (options.entry_data.completion)
+      if (options.entry_data.completion || options.entry_data.completion_file || options.entry_data.completion_cmd)
         {
           GtkEntryCompletion *completion;
           GtkTreeModel *completion_model;
@@ -25,11 +25,35 @@
 
 #include "calendar.xpm"
 
-static GSList *fields = NULL;
+#define FORM_LAZY_FIELDS 100
+#define FORM_LAZY_BATCH 100
+#define FORM_COMBO_FILTER_ITEMS 1000
+
+static GtkWidget **fields = NULL;
+static YadField **field_data = NULL;
+static GHashTable *field_atids = NULL;
 static guint n_fields;
 
+static GtkWidget *form_table;
+static GtkWidget *form_dialog;
+static guint form_rows;
+
+/* postponed creation of fields */
+static gboolean lazy_fields = FALSE;
+static guint next_field = 0;
+static gchar **pending_values = NULL;
+
+static GtkWidget *get_field (guint num);
+
 static gboolean disable_changed = TRUE;
 
+typedef struct {
+  gchar *text;                  /* literal text or NULL for field reference */
+  guint field;
+} YadActionPart;
+
+static GArray *changed_action = NULL;
+
 /* replace single match "@atid" => %N or "@atid:" => N: */
 static gboolean
 preprocess_cb (const GMatchInfo *info, GString *result, gpointer data)
@@ -73,53 +97,82 @@ preprocess_cb (const GMatchInfo *info, GString *result, gpointer data)
 static gboolean
 preprocess_atid (gchar *text, gchar *format, gchar **result)
 {
-  static gchar *fmt = NULL;
-  static GRegex *regex = NULL;
+  /* actions and command output use different formats, so keep a regex for each */
+  static struct {
+    gchar *fmt;
+    GRegex *regex;
+  } cache[2];
   static GHashTable *ht = NULL;
   static gint n_varnames = -1;
+  static guint next = 0;
   gchar *atid, *p, **ap;
+  GRegex *regex = NULL;
   GSList *f;
-  gint num = 1;
+  gint i, num = 1;
 
-  if (n_varnames && g_strcmp0 (format, fmt))
+  if (n_varnames < 0)
     {
-      if (ht)
-        g_hash_table_destroy (ht);
       ht = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
-      ap = g_malloc (sizeof (gchar *) * n_fields + 1);
-      g_free (fmt);
-      fmt = g_strdup (format);
-
       n_varnames = 0;
       for (f = options.form_data.fields; f; f = f->next)
         {
           atid = ((YadField*)f->data)->atid;
           if (atid)
             {
-              p = g_regex_escape_string (atid, strlen (atid));
-              ap[n_varnames] = g_strdup_printf (fmt, p);
-              g_hash_table_insert (ht, atid, g_strdup_printf ("%ld", num));
-
-              g_free (p);
+              g_hash_table_insert (ht, atid, g_strdup_printf ("%d", num));
               ++n_varnames;
             }
           ++num;
         }
+    }
+
+  if (n_varnames == 0)
+    {
+      *result = text;
+      return FALSE;
+    }
 
-      ap[n_varnames] = NULL;
-      if (n_varnames)
+  for (i = 0; i < G_N_ELEMENTS (cache); i++)
+    {
+      if (g_strcmp0 (format, cache[i].fmt) == 0)
         {
-          p = g_strjoinv ("|", ap);
-          if (regex)
-            g_regex_unref (regex);
-          regex = g_regex_new (p, G_REGEX_MULTILINE|G_REGEX_OPTIMIZE, 0, NULL);
+          regex = cache[i].regex;
+          break;
+        }
+    }
 
-          g_free (p);
+  if (i == G_N_ELEMENTS (cache))
+    {
+      ap = g_new (gchar *, n_varnames + 1);
+      i = 0;
+      for (f = options.form_data.fields; f; f = f->next)
+        {
+          atid = ((YadField*)f->data)->atid;
+          if (atid)
+            {
+              p = g_regex_escape_string (atid, strlen (atid));
+              ap[i++] = g_strdup_printf (format, p);
+              g_free (p);
+            }
         }
+      ap[i] = NULL;
+
+      p = g_strjoinv ("|", ap);
+      regex = g_regex_new (p, G_REGEX_MULTILINE|G_REGEX_OPTIMIZE, 0, NULL);
+      g_free (p);
       g_strfreev (ap);
+
+      /* replace the oldest slot */
+      i = next;
+      next = (next + 1) % G_N_ELEMENTS (cache);
+      g_free (cache[i].fmt);
+      if (cache[i].regex)
+        g_regex_unref (cache[i].regex);
+      cache[i].fmt = g_strdup (format);
+      cache[i].regex = regex;
     }
 
-  if (n_varnames > 0 && regex)
+  if (regex)
     *result = g_regex_replace_eval (regex, text, -1, 0, 0, preprocess_cb, ht, NULL);
   else
     *result = text;
@@ -127,17 +180,150 @@ preprocess_atid (gchar *text, gchar *format, gchar **result)
   return *result != text;
 }
 
-/* expand %N in command to fields values */
-static GString *
-expand_action (gchar *command)
+/* get field value as a command argument */
+static gchar *
+get_field_arg (guint num)
 {
-  GString *xcmd;
+  YadField *fld = field_data[num];
+  gchar *buf, *arg = NULL;
+
+  switch (fld->type)
+    {
+    case YAD_FIELD_SIMPLE:
+    case YAD_FIELD_HIDDEN:
+    case YAD_FIELD_READ_ONLY:
+    case YAD_FIELD_COMPLETE:
+    case YAD_FIELD_FILE_SAVE:
+    case YAD_FIELD_DIR_CREATE:
+    case YAD_FIELD_MFILE:
+    case YAD_FIELD_MDIR:
+    case YAD_FIELD_DATE:
+      buf = escape_char ((gchar *) gtk_entry_get_text (GTK_ENTRY (get_field (num))), '"');
+      arg = g_shell_quote (buf ? buf : "");
+      g_free (buf);
+      break;
+    case YAD_FIELD_NUM:
+      {
+        guint prec = gtk_spin_button_get_digits (GTK_SPIN_BUTTON (get_field (num)));
+        arg = g_strdup_printf ("%.*f", prec, gtk_spin_button_get_value (GTK_SPIN_BUTTON (get_field (num))));
+        break;
+      }
+#if !GTK_CHECK_VERSION(3,0,0)
+    case YAD_FIELD_SWITCH:
+#endif
+    case YAD_FIELD_CHECK:
+      arg = g_strdup (print_bool_val (gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (get_field (num)))));
+      break;
+    case YAD_FIELD_COMBO:
+    case YAD_FIELD_COMBO_ENTRY:
+      buf = gtk_combo_box_text_get_active_text (GTK_COMBO_BOX_TEXT (get_field (num)));
+      arg = g_shell_quote (buf ? buf : "");
+      g_free (buf);
+      break;
+#if GTK_CHECK_VERSION(3,0,0)
+    case YAD_FIELD_SWITCH:
+      arg = g_strdup (print_bool_val (gtk_switch_get_state (GTK_SWITCH (get_field (num)))));
+      break;
+#endif
+    case YAD_FIELD_SCALE:
+      arg = g_strdup_printf ("%d", (gint) gtk_range_get_value (GTK_RANGE (get_field (num))));
+      break;
+    case YAD_FIELD_FILE:
+    case YAD_FIELD_DIR:
+      arg = g_shell_quote (gtk_file_chooser_get_filename (GTK_FILE_CHOOSER (get_field (num))));
+      break;
+    case YAD_FIELD_FONT:
+#if !GTK_CHECK_VERSION(3,2,0)
+      arg = g_shell_quote (gtk_font_button_get_font_name (GTK_FONT_BUTTON (get_field (num))));
+#else
+      arg = g_shell_quote (gtk_font_chooser_get_font (GTK_FONT_CHOOSER (get_field (num))));
+#endif
+      break;
+    case YAD_FIELD_LINK:
+      arg = g_shell_quote (gtk_link_button_get_uri (GTK_LINK_BUTTON (get_field (num))));
+      break;
+    case YAD_FIELD_COLOR:
+      {
+#if !GTK_CHECK_VERSION(3,4,0)
+        GdkColor c;
+        GtkColorButton *cb = GTK_COLOR_BUTTON (get_field (num));
+        gtk_color_button_get_color (cb, &c);
+        buf = get_color (&c, gtk_color_button_get_alpha (cb));
+#else
+        GdkRGBA c;
+        GtkColorChooser *cb = GTK_COLOR_CHOOSER (get_field (num));
+        gtk_color_chooser_get_rgba (cb, &c);
+        buf = get_color (&c);
+#endif
+        arg = g_shell_quote (buf ? buf : "");
+        g_free (buf);
+        break;
+      }
+    case YAD_FIELD_TEXT:
+      {
+        GtkTextBuffer *tb;
+        GtkTextIter b, e;
+        gchar *txt;
+
+        tb = gtk_text_view_get_buffer (GTK_TEXT_VIEW (get_field (num)));
+        gtk_text_buffer_get_bounds (tb, &b, &e);
+        txt = gtk_text_buffer_get_text (tb, &b, &e, FALSE);
+
+        /* escape special chars */
+        buf = escape_str (txt);
+        g_free (txt);
+
+        /* escape quotes */
+        txt = escape_char (buf, '"');
+        g_free (buf);
+
+        arg = g_shell_quote (txt ? txt : "");
+        g_free (txt);
+      }
+    default: ;
+    }
+
+  return arg;
+}
+
+static void
+free_action (GArray *action)
+{
+  guint i;
+
+  for (i = 0; i < action->len; i++)
+    g_free (g_array_index (action, YadActionPart, i).text);
+  g_array_free (action, TRUE);
+}
+
+static void
+add_action_text (GArray *action, GString *str)
+{
+  YadActionPart part;
+
+  if (str->len == 0)
+    return;
+
+  part.text = g_strdup (str->str);
+  part.field = 0;
+  g_array_append_val (action, part);
+  g_string_truncate (str, 0);
+}
+
+/* split command to text parts and %N references. @atid are resolved here, so it's done only once */
+static GArray *
+compile_action (gchar *command)
+{
+  GArray *action;
+  GString *str;
   guint i = 0;
   gchar *cmd;
   gboolean needs_free;
 
+  action = g_array_new (FALSE, FALSE, sizeof (YadActionPart));
+  str = g_string_new (NULL);
+
   needs_free = preprocess_atid (command, "\\\\%1$s|%1$s\\b(?!:)", &cmd);
-  xcmd = g_string_new ("");
   while (cmd[i])
     {
       if (cmd[i] == '%')
@@ -145,8 +331,7 @@ expand_action (gchar *command)
           i++;
           if (g_ascii_isdigit (cmd[i]))
             {
-              YadField *fld;
-              gchar *buf, *arg;
+              gchar *buf;
               guint num, j = i;
 
               /* get field num */
@@ -156,142 +341,259 @@ expand_action (gchar *command)
               num = g_ascii_strtoll (buf, NULL, 10);
               g_free (buf);
               if (num > 0 && num <= n_fields)
-                num--;
-              else
-                continue;
-
-              /* get field value */
-              arg = NULL;
-              fld = g_slist_nth_data (options.form_data.fields, num);
-              switch (fld->type)
-                {
-                case YAD_FIELD_SIMPLE:
-                case YAD_FIELD_HIDDEN:
-                case YAD_FIELD_READ_ONLY:
-                case YAD_FIELD_COMPLETE:
-                case YAD_FIELD_FILE_SAVE:
-                case YAD_FIELD_DIR_CREATE:
-                case YAD_FIELD_MFILE:
-                case YAD_FIELD_MDIR:
-                case YAD_FIELD_DATE:
-                  buf = escape_char ((gchar *) gtk_entry_get_text (GTK_ENTRY (g_slist_nth_data (fields, num))), '"');
-                  arg = g_shell_quote (buf ? buf : "");
-                  g_free (buf);
-                  break;
-                case YAD_FIELD_NUM:
-                  {
-                    guint prec = gtk_spin_button_get_digits (GTK_SPIN_BUTTON (g_slist_nth_data (fields, num)));
-                    arg = g_strdup_printf ("%.*f", prec, gtk_spin_button_get_value (GTK_SPIN_BUTTON (g_slist_nth_data (fields, num))));
-                    break;
-                  }
-#if !GTK_CHECK_VERSION(3,0,0)
-                case YAD_FIELD_SWITCH:
-#endif
-                case YAD_FIELD_CHECK:
-                  arg = g_strdup (print_bool_val (gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (g_slist_nth_data (fields, num)))));
-                  break;
-                case YAD_FIELD_COMBO:
-                case YAD_FIELD_COMBO_ENTRY:
-                  buf = gtk_combo_box_text_get_active_text (GTK_COMBO_BOX_TEXT (g_slist_nth_data (fields, num)));
-                  arg = g_shell_quote (buf ? buf : "");
-                  g_free (buf);
-                  break;
-#if GTK_CHECK_VERSION(3,0,0)
-                case YAD_FIELD_SWITCH:
-                  arg = g_strdup (print_bool_val (gtk_switch_get_state (GTK_SWITCH (g_slist_nth_data (fields, num)))));
-                  break;
-#endif
-                case YAD_FIELD_SCALE:
-                  arg = g_strdup_printf ("%d", (gint) gtk_range_get_value (GTK_RANGE (g_slist_nth_data (fields, num))));
-                  break;
-                case YAD_FIELD_FILE:
-                case YAD_FIELD_DIR:
-                  arg = g_shell_quote (gtk_file_chooser_get_filename (GTK_FILE_CHOOSER (g_slist_nth_data (fields, num))));
-                  break;
-                case YAD_FIELD_FONT:
-#if !GTK_CHECK_VERSION(3,2,0)
-                  arg = g_shell_quote (gtk_font_button_get_font_name (GTK_FONT_BUTTON (g_slist_nth_data (fields, num))));
-#else
-                  arg = g_shell_quote (gtk_font_chooser_get_font (GTK_FONT_CHOOSER (g_slist_nth_data (fields, num))));
-#endif
-                  break;
-                case YAD_FIELD_LINK:
-                  arg = g_shell_quote (gtk_link_button_get_uri (GTK_LINK_BUTTON (g_slist_nth_data (fields, num))));
-                  break;
-                case YAD_FIELD_COLOR:
-                  {
-#if !GTK_CHECK_VERSION(3,4,0)
-                    GdkColor c;
-                    GtkColorButton *cb = GTK_COLOR_BUTTON (g_slist_nth_data (fields, num));
-                    gtk_color_button_get_color (cb, &c);
-                    buf = get_color (&c, gtk_color_button_get_alpha (cb));
-#else
-                    GdkRGBA c;
-                    GtkColorChooser *cb = GTK_COLOR_CHOOSER (g_slist_nth_data (fields, num));
-                    gtk_color_chooser_get_rgba (cb, &c);
-                    buf = get_color (&c);
-#endif
-                    arg = g_shell_quote (buf ? buf : "");
-                    g_free (buf);
-                    break;
-                  }
-                case YAD_FIELD_TEXT:
-                  {
-                    GtkTextBuffer *tb;
-                    GtkTextIter b, e;
-                    gchar *txt;
-
-                    tb = gtk_text_view_get_buffer (GTK_TEXT_VIEW (g_slist_nth_data (fields, num)));
-                    gtk_text_buffer_get_bounds (tb, &b, &e);
-                    txt = gtk_text_buffer_get_text (tb, &b, &e, FALSE);
-
-                    /* escape special chars */
-                    buf = escape_str (txt);
-                    g_free (txt);
-
-                    /* escape quotes */
-                    txt = escape_char (buf, '"');
-                    g_free (buf);
-
-                    arg = g_shell_quote (txt ? txt : "");
-                    g_free (txt);
-                  }
-                default: ;
-                }
-              if (arg)
                 {
-                  g_string_append (xcmd, arg);
-                  g_free (arg);
+                  YadActionPart part;
+
+                  add_action_text (action, str);
+                  part.text = NULL;
+                  part.field = num - 1;
+                  g_array_append_val (action, part);
+                  i = j;
                 }
-              i = j;
             }
-          else
+          else if (cmd[i])
             {
-              g_string_append_c (xcmd, cmd[i]);
+              g_string_append_c (str, cmd[i]);
               i++;
             }
         }
       else
         {
-          g_string_append_c (xcmd, cmd[i]);
+          g_string_append_c (str, cmd[i]);
           i++;
         }
     }
-  g_string_append_c (xcmd, '\0');
+  add_action_text (action, str);
+
+  g_string_free (str, TRUE);
   if (needs_free)
     g_free (cmd);
 
+  return action;
+}
+
+/* expand %N in command to fields values */
+static GString *
+expand_action (GArray *action)
+{
+  GString *xcmd;
+  guint i;
+
+  xcmd = g_string_new ("");
+  for (i = 0; i < action->len; i++)
+    {
+      YadActionPart *part = &g_array_index (action, YadActionPart, i);
+
+      if (part->text)
+        g_string_append (xcmd, part->text);
+      else
+        {
+          gchar *arg = get_field_arg (part->field);
+          if (arg)
+            {
+              g_string_append (xcmd, arg);
+              g_free (arg);
+            }
+        }
+    }
+
   return xcmd;
 }
 
+/* show item from search index in a large combo */
+static void
+combo_set_item (GtkWidget *w, gint id)
+{
+  GtkTreeModel *items, *m;
+  GtkTreeIter it;
+  gchar *text = NULL;
+
+  items = g_object_get_data (G_OBJECT (w), "yad-combo-items");
+  if (!gtk_tree_model_iter_nth_child (items, &it, NULL, id))
+    return;
+  gtk_tree_model_get (items, &it, 0, &text, -1);
+  g_object_set_data (G_OBJECT (w), "yad-combo-active", GINT_TO_POINTER (id + 1));
+
+  /* combo itself holds only the selected item */
+  m = gtk_combo_box_get_model (GTK_COMBO_BOX (w));
+  if (gtk_tree_model_get_iter_first (m, &it))
+    {
+      gtk_list_store_set (GTK_LIST_STORE (m), &it, 0, text, -1);
+      if (gtk_combo_box_get_active (GTK_COMBO_BOX (w)) == 0)
+        g_signal_emit_by_name (w, "changed");
+      else
+        gtk_combo_box_set_active (GTK_COMBO_BOX (w), 0);
+    }
+  else
+    {
+      gtk_list_store_insert_with_values (GTK_LIST_STORE (m), NULL, -1, 0, text, -1);
+      gtk_combo_box_set_active (GTK_COMBO_BOX (w), 0);
+    }
+
+  g_free (text);
+}
+
+static gint
+combo_get_active (GtkWidget *w)
+{
+  if (g_object_get_data (G_OBJECT (w), "yad-combo-items"))
+    return GPOINTER_TO_INT (g_object_get_data (G_OBJECT (w), "yad-combo-active")) - 1;
+  return gtk_combo_box_get_active (GTK_COMBO_BOX (w));
+}
+
+static gboolean
+combo_item_visible (GtkTreeModel *m, GtkTreeIter *it, gpointer data)
+{
+  gchar *key = g_object_get_data (G_OBJECT (data), "yad-combo-key");
+
+  if (!key || !key[0])
+    return TRUE;
+  return completion_model_match (m, key, it);
+}
+
+static void
+combo_filter_changed_cb (GtkEntry *e, GtkTreeView *tv)
+{
+  GtkTreeModel *f;
+  gchar *norm;
+
+  norm = g_utf8_normalize (gtk_entry_get_text (e), -1, G_NORMALIZE_ALL);
+  g_object_set_data_full (G_OBJECT (e), "yad-combo-key", g_utf8_casefold (norm, -1), g_free);
+  g_free (norm);
+
+  /* refilter detached model, otherwise view handles each row separately */
+  f = g_object_ref (gtk_tree_view_get_model (tv));
+  gtk_tree_view_set_model (tv, NULL);
+  gtk_tree_model_filter_refilter (GTK_TREE_MODEL_FILTER (f));
+  gtk_tree_view_set_model (tv, f);
+  g_object_unref (f);
+}
+
+static void
+combo_filter_activate_cb (GtkWidget *w, gpointer data)
+{
+  gtk_dialog_response (GTK_DIALOG (data), GTK_RESPONSE_ACCEPT);
+}
+
+static void
+combo_row_activated_cb (GtkTreeView *tv, GtkTreePath *path, GtkTreeViewColumn *col, gpointer data)
+{
+  gtk_dialog_response (GTK_DIALOG (data), GTK_RESPONSE_ACCEPT);
+}
+
+/* type-to-filter selection for combos with many items */
+static gboolean
+combo_select_item (gpointer data)
+{
+  GtkWidget *w = GTK_WIDGET (data);
+  GtkWidget *dlg, *box, *e, *sw, *tv;
+  GtkTreeModel *items, *f;
+  GtkTreeViewColumn *col;
+  GtkTreeIter it;
+  GtkTreePath *path;
+
+  items = g_object_get_data (G_OBJECT (w), "yad-combo-items");
+  if (!items)
+    return FALSE;
+
+  SETUNDEPR (dlg, gtk_dialog_new_with_buttons, _("Select item"),
+                                     GTK_WINDOW (gtk_widget_get_toplevel (w)),
+                                     GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT,
+                                     GTK_STOCK_CANCEL, GTK_RESPONSE_CANCEL,
+                                     GTK_STOCK_OK, GTK_RESPONSE_ACCEPT, NULL);
+  gtk_window_set_default_size (GTK_WINDOW (dlg), -1, 400);
+  box = gtk_dialog_get_content_area (GTK_DIALOG (dlg));
+
+  e = gtk_entry_new ();
+  gtk_box_pack_start (GTK_BOX (box), e, FALSE, FALSE, 5);
+
+  f = gtk_tree_model_filter_new (items, NULL);
+  gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (f), combo_item_visible, e, NULL);
+
+  tv = gtk_tree_view_new_with_model (f);
+  g_object_unref (f);
+  gtk_tree_view_set_headers_visible (GTK_TREE_VIEW (tv), FALSE);
+  col = gtk_tree_view_column_new_with_attributes (NULL, gtk_cell_renderer_text_new (), "text", 0, NULL);
+  gtk_tree_view_column_set_sizing (col, GTK_TREE_VIEW_COLUMN_FIXED);
+  gtk_tree_view_append_column (GTK_TREE_VIEW (tv), col);
+  gtk_tree_view_set_fixed_height_mode (GTK_TREE_VIEW (tv), TRUE);
+
+  sw = gtk_scrolled_window_new (NULL, NULL);
+  gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (sw), GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+  gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (sw), GTK_SHADOW_ETCHED_IN);
+  gtk_container_add (GTK_CONTAINER (sw), tv);
+  gtk_box_pack_start (GTK_BOX (box), sw, TRUE, TRUE, 5);
+
+  g_signal_connect (G_OBJECT (e), "changed", G_CALLBACK (combo_filter_changed_cb), tv);
+  g_signal_connect (G_OBJECT (e), "activate", G_CALLBACK (combo_filter_activate_cb), dlg);
+  g_signal_connect (G_OBJECT (tv), "row-activated", G_CALLBACK (combo_row_activated_cb), dlg);
+
+  /* start from current item */
+  if (combo_get_active (w) >= 0)
+    {
+      path = gtk_tree_path_new_from_indices (combo_get_active (w), -1);
+      gtk_tree_view_set_cursor (GTK_TREE_VIEW (tv), path, NULL, FALSE);
+      gtk_tree_path_free (path);
+    }
+
+  gtk_widget_show_all (box);
+  gtk_widget_grab_focus (e);
+
+  if (gtk_dialog_run (GTK_DIALOG (dlg)) == GTK_RESPONSE_ACCEPT)
+    {
+      GtkTreeSelection *sel = gtk_tree_view_get_selection (GTK_TREE_VIEW (tv));
+
+      f = gtk_tree_view_get_model (GTK_TREE_VIEW (tv));
+      if (gtk_tree_selection_get_selected (sel, NULL, &it) || gtk_tree_model_get_iter_first (f, &it))
+        {
+          GtkTreeIter child;
+          guint id;
+
+          gtk_tree_model_filter_convert_iter_to_child_iter (GTK_TREE_MODEL_FILTER (f), &child, &it);
+          gtk_tree_model_get (items, &child, 1, &id, -1);
+          combo_set_item (w, id);
+        }
+    }
+  gtk_widget_destroy (dlg);
+
+  gtk_widget_grab_focus (w);
+
+  return FALSE;
+}
+
+static void
+combo_popup_cb (GObject *obj, GParamSpec *spec, gpointer data)
+{
+  gboolean shown;
+
+  if (!g_object_get_data (obj, "yad-combo-items"))
+    return;
+
+  g_object_get (obj, "popup-shown", &shown, NULL);
+  if (shown)
+    {
+      /* replace native popup with filter dialog */
+      gtk_combo_box_popdown (GTK_COMBO_BOX (obj));
+      g_idle_add (combo_select_item, obj);
+    }
+}
+
 static void
 set_field_value (guint num, gchar *value)
 {
   GtkWidget *w;
   gchar **s;
-  YadField *fld = g_slist_nth_data (options.form_data.fields, num);
+  YadField *fld = field_data[num];
+
+  if (fields[num] == NULL)
+    {
+      /* value will be set when field is created */
+      g_free (pending_values[num]);
+      pending_values[num] = g_strdup (value);
+      return;
+    }
 
-  w = GTK_WIDGET (g_slist_nth_data (fields, num));
+  w = fields[num];
   if (g_ascii_strcasecmp (value, "@disabled@") == 0)
     {
       gtk_widget_set_sensitive (w, FALSE);
@@ -319,7 +621,6 @@ set_field_value (guint num, gchar *value)
       if (s[0])
         {
           gdouble val = g_ascii_strtod (s[0], NULL);
-          w = g_slist_nth_data (fields, num);
           if (s[1])
             {
               gchar **s1 = g_strsplit (s[1], "..", 2);
@@ -368,24 +669,26 @@ set_field_value (guint num, gchar *value)
       {
         GtkEntryCompletion *c;
         GtkTreeModel *m;
-        GtkTreeIter it;
         gint i = 0, def = -1;
 
         c = gtk_entry_get_completion (GTK_ENTRY (w));
         m = gtk_entry_completion_get_model (GTK_ENTRY_COMPLETION (c));
-        gtk_list_store_clear (GTK_LIST_STORE (m));
+        completion_model_clear (m);
 
         s = g_strsplit (value, options.common_data.item_separator, -1);
         while (s[i])
           {
-            gtk_list_store_append (GTK_LIST_STORE (m), &it);
+            gchar *buf;
+
             if (s[i][0] == '^')
               {
-                gtk_list_store_set (GTK_LIST_STORE (m), &it, 0, g_strcompress (s[i] + 1), -1);
+                buf = g_strcompress (s[i] + 1);
                 def = i;
               }
             else
-              gtk_list_store_set (GTK_LIST_STORE (m), &it, 0, g_strcompress (s[i]), -1);
+              buf = g_strcompress (s[i]);
+            completion_model_add (m, buf);
+            g_free (buf);
 
             i++;
           }
@@ -400,14 +703,24 @@ set_field_value (guint num, gchar *value)
     case YAD_FIELD_COMBO:
     case YAD_FIELD_COMBO_ENTRY:
       {
-        GtkTreeModel *m;
+        GtkTreeModel *m, *items = NULL;
         gint i = 0, def = 0;
 
-        /* cleanup previous values */
-        m = gtk_combo_box_get_model (GTK_COMBO_BOX (w));
+        s = g_strsplit (value, options.common_data.item_separator, -1);
+
+        /* fill detached model at once */
+        m = g_object_ref (gtk_combo_box_get_model (GTK_COMBO_BOX (w)));
+        gtk_combo_box_set_model (GTK_COMBO_BOX (w), NULL);
         gtk_list_store_clear (GTK_LIST_STORE (m));
 
-        s = g_strsplit (value, options.common_data.item_separator, -1);
+        /* large sets goes to search index instead of combo popup */
+        if (g_strv_length (s) > FORM_COMBO_FILTER_ITEMS)
+          {
+            items = completion_model_new ();
+            /* filter finds items by any part of text */
+            completion_model_set_type (items, YAD_COMPLETE_ANY);
+          }
+
         while (s[i])
           {
             gchar *buf;
@@ -419,12 +732,28 @@ set_field_value (guint num, gchar *value)
               }
             else
               buf = g_strcompress (s[i]);
-            gtk_combo_box_text_append_text (GTK_COMBO_BOX_TEXT (w), buf);
+            if (items)
+              completion_model_add (items, buf);
+            else
+              gtk_list_store_insert_with_values (GTK_LIST_STORE (m), NULL, -1, 0, buf, -1);
             g_free (buf);
             i++;
           }
-        gtk_combo_box_set_active (GTK_COMBO_BOX (w), def);
         g_strfreev (s);
+
+        gtk_combo_box_set_model (GTK_COMBO_BOX (w), m);
+        g_object_unref (m);
+
+        if (items)
+          {
+            g_object_set_data_full (G_OBJECT (w), "yad-combo-items", items, g_object_unref);
+            combo_set_item (w, def);
+          }
+        else
+          {
+            g_object_set_data (G_OBJECT (w), "yad-combo-items", NULL);
+            gtk_combo_box_set_active (GTK_COMBO_BOX (w), def);
+          }
         break;
       }
 
@@ -463,6 +792,8 @@ set_field_value (guint num, gchar *value)
     case YAD_FIELD_BUTTON:
     case YAD_FIELD_FULL_BUTTON:
       g_object_set_data_full (G_OBJECT (w), "cmd", g_strdup (value), g_free);
+      g_object_set_data_full (G_OBJECT (w), "action", compile_action (value[0] == '@' ? value + 1 : value),
+                              (GDestroyNotify) free_action);
       break;
 
     case YAD_FIELD_LINK:
@@ -527,27 +858,26 @@ button_clicked_cb (GtkButton * b, gpointer d)
   if (action && action[0])
     {
       GString *cmd;
+
+      cmd = expand_action ((GArray *) g_object_get_data (G_OBJECT (b), "action"));
       if (action[0] == '@')
         {
           gchar *data = NULL;
           gint exit = 1;
-          cmd = expand_action (action + 1);
+
           exit = run_command_sync (cmd->str, &data, GTK_WIDGET (b));
           if (exit == 0)
             parse_cmd_output (data);
           g_free (data);
         }
       else
-        {
-          cmd = expand_action (action);
-          run_command_async (cmd->str);
-        }
+        run_command_async (cmd->str);
       g_string_free (cmd, TRUE);
     }
 
   /* set focus to specified field */
   if (options.form_data.focus_field > 0 && options.form_data.focus_field <= n_fields)
-    gtk_widget_grab_focus (GTK_WIDGET (g_slist_nth_data (fields, options.form_data.focus_field - 1)));
+    gtk_widget_grab_focus (get_field (options.form_data.focus_field - 1));
 }
 
 static void
@@ -559,14 +889,19 @@ field_changed_cb (GtkWidget *w, guint fn)
   if (disable_changed)
     return;
 
-  if (options.form_data.changed_action)
+  if (changed_action)
     {
-      gchar *str;
       GString *cmd;
+      gchar *arg;
 
-      str = g_strdup_printf ("%s %d %%%d", options.form_data.changed_action, fn + 1, fn + 1);
-      cmd = expand_action (str);
-      g_free (str);
+      cmd = expand_action (changed_action);
+      g_string_append_printf (cmd, " %d ", fn + 1);
+      arg = get_field_arg (fn);
+      if (arg)
+        {
+          g_string_append (cmd, arg);
+          g_free (arg);
+        }
 
       exit = run_command_sync (cmd->str, &data, w);
       if (exit == 0)
@@ -900,646 +1235,841 @@ handle_stdin (GIOChannel * ch, GIOCondition cond, gpointer data)
   return FALSE;
 }
 
-GtkWidget *
-form_create_widget (GtkWidget * dlg)
+/* create widgets of one field. in lazy mode it may be called in any order */
+static void
+create_field (guint i)
 {
-  GtkWidget *tbl, *w = NULL;
+  GtkWidget *tbl = form_table, *dlg = form_dialog;
+  GtkWidget *l, *e;
+  GdkPixbuf *pb;
   GList *filt;
-
-  if (options.form_data.fields)
+  YadField *fld = field_data[i];
+  guint row = i % form_rows;
+  guint col = i / form_rows;
+
+  /* add field label */
+  l = NULL;
+  if (fld->type != YAD_FIELD_CHECK && fld->type != YAD_FIELD_BUTTON &&
+      fld->type != YAD_FIELD_FULL_BUTTON && fld->type != YAD_FIELD_LINK &&
+#if !GTK_CHECK_VERSION(3,0,0)
+      fld->type != YAD_FIELD_SWITCH &&
+#endif
+      fld->type != YAD_FIELD_LABEL && fld->type != YAD_FIELD_TEXT)
     {
-      GtkWidget *l, *e;
-      GdkPixbuf *pb;
-      guint i, col, row, rows;
+      gchar *buf;
 
-      n_fields = g_slist_length (options.form_data.fields);
+      if (fld->name)
+        buf = g_strcompress (fld->name);
+      else
+        buf = g_strdup ("");
 
-      row = col = 0;
-      rows = n_fields / options.form_data.columns;
-      if (n_fields % options.form_data.columns > 0)
-        rows++;
-
-#if !GTK_CHECK_VERSION(3,0,0)
-      tbl = gtk_table_new (n_fields, 2 * options.form_data.columns, FALSE);
-#else
-      tbl = gtk_grid_new ();
-      gtk_grid_set_row_spacing (GTK_GRID (tbl), 5);
-      gtk_grid_set_column_spacing (GTK_GRID (tbl), 5);
-      gtk_grid_set_row_homogeneous (GTK_GRID (tbl), options.form_data.homogeneous);
-#endif
-
-      if (options.form_data.scroll)
+      l = gtk_label_new (NULL);
+      if (!options.data.no_markup)
         {
-          GtkWidget *sw = gtk_scrolled_window_new (NULL, NULL);
-          gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (sw), GTK_SHADOW_NONE);
-          gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (sw), options.hscroll_policy, options.vscroll_policy);
-
-
-#if !GTK_CHECK_VERSION(3,0,0)
-          gtk_scrolled_window_add_with_viewport (GTK_SCROLLED_WINDOW (sw), tbl);
-#else
-          gtk_container_add (GTK_CONTAINER (sw), tbl);
-#endif
-          w = sw;
+          gtk_label_set_markup_with_mnemonic (GTK_LABEL (l), buf);
+          if (fld->tip)
+            gtk_widget_set_tooltip_markup (l, fld->tip);
         }
       else
-        w = tbl;
-
-      /* create form */
-      for (i = 0; i < n_fields; i++)
         {
-          YadField *fld = g_slist_nth_data (options.form_data.fields, i);
-
-          /* add field label */
-          l = NULL;
-          if (fld->type != YAD_FIELD_CHECK && fld->type != YAD_FIELD_BUTTON &&
-              fld->type != YAD_FIELD_FULL_BUTTON && fld->type != YAD_FIELD_LINK &&
-#if !GTK_CHECK_VERSION(3,0,0)
-              fld->type != YAD_FIELD_SWITCH &&
-#endif
-              fld->type != YAD_FIELD_LABEL && fld->type != YAD_FIELD_TEXT)
-            {
-              gchar *buf;
-
-              if (fld->name)
-                buf = g_strcompress (fld->name);
-              else
-                buf = g_strdup ("");
-
-              l = gtk_label_new (NULL);
-              if (!options.data.no_markup)
-                {
-                  gtk_label_set_markup_with_mnemonic (GTK_LABEL (l), buf);
-                  if (fld->tip)
-                    gtk_widget_set_tooltip_markup (l, fld->tip);
-                }
-              else
-                {
-                  gtk_label_set_text_with_mnemonic (GTK_LABEL (l), buf);
-                  if (fld->tip)
-                    gtk_widget_set_tooltip_text (l, fld->tip);
-                }
-              gtk_widget_set_name (l, "yad-form-flabel");
+          gtk_label_set_text_with_mnemonic (GTK_LABEL (l), buf);
+          if (fld->tip)
+            gtk_widget_set_tooltip_text (l, fld->tip);
+        }
+      gtk_widget_set_name (l, "yad-form-flabel");
 #if !GTK_CHECK_VERSION(3,0,0)
-              gtk_misc_set_alignment (GTK_MISC (l), options.common_data.align, 0.5);
-              gtk_table_attach (GTK_TABLE (tbl), l, col * 2, 1 + col * 2, row, row + 1, GTK_FILL, 0, 5, 5);
+      gtk_misc_set_alignment (GTK_MISC (l), options.common_data.align, 0.5);
+      gtk_table_attach (GTK_TABLE (tbl), l, col * 2, 1 + col * 2, row, row + 1, GTK_FILL, 0, 5, 5);
 #else
-              gtk_label_set_xalign (GTK_LABEL (l), options.common_data.align);
-              gtk_grid_attach (GTK_GRID (tbl), l, col * 2, row, 1, 1);
+      gtk_label_set_xalign (GTK_LABEL (l), options.common_data.align);
+      gtk_grid_attach (GTK_GRID (tbl), l, col * 2, row, 1, 1);
 #endif
-              g_free (buf);
-            }
+      g_free (buf);
+    }
 
-          /* add field entry */
-          switch (fld->type)
-            {
-            case YAD_FIELD_SIMPLE:
-            case YAD_FIELD_HIDDEN:
-            case YAD_FIELD_READ_ONLY:
-            case YAD_FIELD_COMPLETE:
-              e = gtk_entry_new ();
-              gtk_widget_set_name (e, "yad-form-entry");
-              if (fld->tip)
-                {
-                  if (!options.data.no_markup)
-                    gtk_widget_set_tooltip_markup (e, fld->tip);
-                  else
-                    gtk_widget_set_tooltip_text (e, fld->tip);
-                }
-              g_signal_connect (G_OBJECT (e), "activate", G_CALLBACK (form_activate_cb), dlg);
-              if (fld->type == YAD_FIELD_HIDDEN)
-                gtk_entry_set_visibility (GTK_ENTRY (e), FALSE);
-              else if (fld->type == YAD_FIELD_READ_ONLY)
-                gtk_widget_set_sensitive (e, FALSE);
+  /* add field entry */
+  switch (fld->type)
+    {
+    case YAD_FIELD_SIMPLE:
+    case YAD_FIELD_HIDDEN:
+    case YAD_FIELD_READ_ONLY:
+    case YAD_FIELD_COMPLETE:
+      e = gtk_entry_new ();
+      gtk_widget_set_name (e, "yad-form-entry");
+      if (fld->tip)
+        {
+          if (!options.data.no_markup)
+            gtk_widget_set_tooltip_markup (e, fld->tip);
+          else
+            gtk_widget_set_tooltip_text (e, fld->tip);
+        }
+      g_signal_connect (G_OBJECT (e), "activate", G_CALLBACK (form_activate_cb), dlg);
+      if (fld->type == YAD_FIELD_HIDDEN)
+        gtk_entry_set_visibility (GTK_ENTRY (e), FALSE);
+      else if (fld->type == YAD_FIELD_READ_ONLY)
+        gtk_widget_set_sensitive (e, FALSE);
 #if !GTK_CHECK_VERSION(3,0,0)
-              gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
-                                GTK_EXPAND | GTK_FILL, 0, 5, 5);
+      gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
+                        GTK_EXPAND | GTK_FILL, 0, 5, 5);
 #else
-              gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
-              gtk_widget_set_hexpand (e, TRUE);
+      gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
+      gtk_widget_set_hexpand (e, TRUE);
 #endif
-              if (fld->type == YAD_FIELD_COMPLETE)
-                {
-                  GtkEntryCompletion *c = gtk_entry_completion_new ();
-                  GtkListStore *m = gtk_list_store_new (1, G_TYPE_STRING);
+      if (fld->type == YAD_FIELD_COMPLETE)
+        {
+          GtkEntryCompletion *c = gtk_entry_completion_new ();
+          GtkTreeModel *m = completion_model_new ();
 
-                  gtk_entry_set_completion (GTK_ENTRY (e), c);
-                  gtk_entry_completion_set_model (c, GTK_TREE_MODEL (m));
-                  gtk_entry_completion_set_text_column (c, 0);
+          gtk_entry_set_completion (GTK_ENTRY (e), c);
+          gtk_entry_completion_set_model (c, m);
+          gtk_entry_completion_set_text_column (c, 0);
 
-                  if (options.common_data.complete != YAD_COMPLETE_SIMPLE)
-                    gtk_entry_completion_set_match_func (c, check_complete, NULL, NULL);
+          if (options.common_data.complete != YAD_COMPLETE_SIMPLE)
+            gtk_entry_completion_set_match_func (c, check_complete, NULL, NULL);
 
-                  g_object_unref (m);
-                  g_object_unref (c);
-                }
+          g_object_unref (m);
+          g_object_unref (c);
+        }
 
-              gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
-              fields = g_slist_append (fields, e);
-              break;
+      gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
+      fields[i] = e;
+      break;
 
-            case YAD_FIELD_NUM:
-              e = gtk_spin_button_new_with_range (0.0, 65525.0, 1.0);
-              gtk_widget_set_name (e, "yad-form-spin");
-              if (fld->tip)
-                {
-                  if (!options.data.no_markup)
-                    gtk_widget_set_tooltip_markup (e, fld->tip);
-                  else
-                    gtk_widget_set_tooltip_text (e, fld->tip);
-                }
-              gtk_entry_set_alignment (GTK_ENTRY (e), 1.0);
+    case YAD_FIELD_NUM:
+      e = gtk_spin_button_new_with_range (0.0, 65525.0, 1.0);
+      gtk_widget_set_name (e, "yad-form-spin");
+      if (fld->tip)
+        {
+          if (!options.data.no_markup)
+            gtk_widget_set_tooltip_markup (e, fld->tip);
+          else
+            gtk_widget_set_tooltip_text (e, fld->tip);
+        }
+      gtk_entry_set_alignment (GTK_ENTRY (e), 1.0);
 #if !GTK_CHECK_VERSION(3,0,0)
-              gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
-                                GTK_EXPAND | GTK_FILL, 0, 5, 5);
+      gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
+                        GTK_EXPAND | GTK_FILL, 0, 5, 5);
 #else
-              gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
-              gtk_widget_set_hexpand (e, TRUE);
+      gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
+      gtk_widget_set_hexpand (e, TRUE);
 #endif
-              gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
-              fields = g_slist_append (fields, e);
-              break;
+      gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
+      fields[i] = e;
+      break;
 
 #if !GTK_CHECK_VERSION(3,0,0)
-            case YAD_FIELD_SWITCH:
+    case YAD_FIELD_SWITCH:
 #endif
-            case YAD_FIELD_CHECK:
-              {
-                gchar *buf;
-                if (fld->name)
-                  buf = g_strcompress (fld->name);
-                else
-                  buf = g_strdup ("");
-                e = gtk_check_button_new_with_label (buf);
-                gtk_widget_set_name (e, "yad-form-check");
-                if (fld->tip)
-                  {
-                    if (!options.data.no_markup)
-                      gtk_widget_set_tooltip_markup (e, fld->tip);
-                    else
-                      gtk_widget_set_tooltip_text (e, fld->tip);
-                  }
+    case YAD_FIELD_CHECK:
+      {
+        gchar *buf;
+        if (fld->name)
+          buf = g_strcompress (fld->name);
+        else
+          buf = g_strdup ("");
+        e = gtk_check_button_new_with_label (buf);
+        gtk_widget_set_name (e, "yad-form-check");
+        if (fld->tip)
+          {
+            if (!options.data.no_markup)
+              gtk_widget_set_tooltip_markup (e, fld->tip);
+            else
+              gtk_widget_set_tooltip_text (e, fld->tip);
+          }
 #if !GTK_CHECK_VERSION(3,0,0)
-                gtk_table_attach (GTK_TABLE (tbl), e, col * 2, 2 + col * 2, row, row + 1,
-                                  GTK_EXPAND | GTK_FILL, 0, 5, 5);
+        gtk_table_attach (GTK_TABLE (tbl), e, col * 2, 2 + col * 2, row, row + 1,
+                          GTK_EXPAND | GTK_FILL, 0, 5, 5);
 #else
-                gtk_grid_attach (GTK_GRID (tbl), e, col * 2, row, 2, 1);
-                gtk_widget_set_hexpand (e, TRUE);
+        gtk_grid_attach (GTK_GRID (tbl), e, col * 2, row, 2, 1);
+        gtk_widget_set_hexpand (e, TRUE);
 #endif
-                fields = g_slist_append (fields, e);
-                g_free (buf);
-                g_signal_connect_after (G_OBJECT (e), "toggled", G_CALLBACK (field_changed_cb), GINT_TO_POINTER (i));
-              }
-              break;
+        fields[i] = e;
+        g_free (buf);
+        g_signal_connect_after (G_OBJECT (e), "toggled", G_CALLBACK (field_changed_cb), GINT_TO_POINTER (i));
+      }
+      break;
 
 #if GTK_CHECK_VERSION(3,0,0)
-            case YAD_FIELD_SWITCH:
-               {
-                 e = gtk_switch_new ();
-                 gtk_widget_set_name (e, "yad-form-switch");
-                 if (fld->tip)
-                   {
-                     if (!options.data.no_markup)
-                       gtk_widget_set_tooltip_markup (e, fld->tip);
-                     else
-                       gtk_widget_set_tooltip_text (e, fld->tip);
-                   }
-                 gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
-                 gtk_widget_set_hexpand (e, TRUE);
-                 gtk_widget_set_halign (e, GTK_ALIGN_START); /* prevent expanding widget (make it always compact) */
-                 gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
-                 fields = g_slist_append (fields, e);
-                 g_signal_connect_after (G_OBJECT (e), "notify::active", G_CALLBACK (switch_changed_cb), GINT_TO_POINTER (i));
-               }
-               break;
+    case YAD_FIELD_SWITCH:
+       {
+         e = gtk_switch_new ();
+         gtk_widget_set_name (e, "yad-form-switch");
+         if (fld->tip)
+           {
+             if (!options.data.no_markup)
+               gtk_widget_set_tooltip_markup (e, fld->tip);
+             else
+               gtk_widget_set_tooltip_text (e, fld->tip);
+           }
+         gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
+         gtk_widget_set_hexpand (e, TRUE);
+         gtk_widget_set_halign (e, GTK_ALIGN_START); /* prevent expanding widget (make it always compact) */
+         gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
+         fields[i] = e;
+         g_signal_connect_after (G_OBJECT (e), "notify::active", G_CALLBACK (switch_changed_cb), GINT_TO_POINTER (i));
+       }
+       break;
 #endif
 
-            case YAD_FIELD_COMBO:
-              e = gtk_combo_box_text_new ();
-              gtk_widget_set_name (e, "yad-form-combo");
-              if (fld->tip)
-                {
-                  if (!options.data.no_markup)
-                    gtk_widget_set_tooltip_markup (e, fld->tip);
-                  else
-                    gtk_widget_set_tooltip_text (e, fld->tip);
-                }
+    case YAD_FIELD_COMBO:
+      e = gtk_combo_box_text_new ();
+      gtk_widget_set_name (e, "yad-form-combo");
+      if (fld->tip)
+        {
+          if (!options.data.no_markup)
+            gtk_widget_set_tooltip_markup (e, fld->tip);
+          else
+            gtk_widget_set_tooltip_text (e, fld->tip);
+        }
 #if !GTK_CHECK_VERSION(3,0,0)
-              gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
-                                GTK_EXPAND | GTK_FILL, 0, 5, 5);
+      gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
+                        GTK_EXPAND | GTK_FILL, 0, 5, 5);
 #else
-              gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
-              gtk_widget_set_hexpand (e, TRUE);
+      gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
+      gtk_widget_set_hexpand (e, TRUE);
 #endif
-              gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
-              fields = g_slist_append (fields, e);
-              g_signal_connect_after (G_OBJECT (e), "changed", G_CALLBACK (field_changed_cb), GINT_TO_POINTER (i));
-              break;
-
-            case YAD_FIELD_COMBO_ENTRY:
-              e = gtk_combo_box_text_new_with_entry ();
-              gtk_widget_set_name (e, "yad-form-edit-combo");
-              if (fld->tip)
-                {
-                  if (!options.data.no_markup)
-                    gtk_widget_set_tooltip_markup (e, fld->tip);
-                  else
-                    gtk_widget_set_tooltip_text (e, fld->tip);
-                }
+      gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
+      fields[i] = e;
+      g_signal_connect_after (G_OBJECT (e), "changed", G_CALLBACK (field_changed_cb), GINT_TO_POINTER (i));
+      g_signal_connect (G_OBJECT (e), "notify::popup-shown", G_CALLBACK (combo_popup_cb), NULL);
+      break;
+
+    case YAD_FIELD_COMBO_ENTRY:
+      e = gtk_combo_box_text_new_with_entry ();
+      gtk_widget_set_name (e, "yad-form-edit-combo");
+      if (fld->tip)
+        {
+          if (!options.data.no_markup)
+            gtk_widget_set_tooltip_markup (e, fld->tip);
+          else
+            gtk_widget_set_tooltip_text (e, fld->tip);
+        }
 #if !GTK_CHECK_VERSION(3,0,0)
-              gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
-                                GTK_EXPAND | GTK_FILL, 0, 5, 5);
+      gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
+                        GTK_EXPAND | GTK_FILL, 0, 5, 5);
 #else
-              gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
-              gtk_widget_set_hexpand (e, TRUE);
+      gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
+      gtk_widget_set_hexpand (e, TRUE);
 #endif
-              gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
-              fields = g_slist_append (fields, e);
-              break;
-
-            case YAD_FIELD_FILE:
-              e = gtk_file_chooser_button_new (_("Select file"), GTK_FILE_CHOOSER_ACTION_OPEN);
-              gtk_widget_set_name (e, "yad-form-file");
-              if (fld->tip)
-                {
-                  if (!options.data.no_markup)
-                    gtk_widget_set_tooltip_markup (e, fld->tip);
-                  else
-                    gtk_widget_set_tooltip_text (e, fld->tip);
-                }
-              gtk_file_chooser_set_current_folder (GTK_FILE_CHOOSER (e), g_get_current_dir ());
+      gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
+      fields[i] = e;
+      g_signal_connect (G_OBJECT (e), "notify::popup-shown", G_CALLBACK (combo_popup_cb), NULL);
+      break;
 
-              /* add preview */
-              if (options.common_data.preview)
-                {
-                  GtkWidget *p = gtk_image_new ();
-                  gtk_file_chooser_set_preview_widget (GTK_FILE_CHOOSER (e), p);
-                  g_signal_connect (e, "update-preview", G_CALLBACK (update_preview), p);
-                }
+    case YAD_FIELD_FILE:
+      e = gtk_file_chooser_button_new (_("Select file"), GTK_FILE_CHOOSER_ACTION_OPEN);
+      gtk_widget_set_name (e, "yad-form-file");
+      if (fld->tip)
+        {
+          if (!options.data.no_markup)
+            gtk_widget_set_tooltip_markup (e, fld->tip);
+          else
+            gtk_widget_set_tooltip_text (e, fld->tip);
+        }
+      gtk_file_chooser_set_current_folder (GTK_FILE_CHOOSER (e), g_get_current_dir ());
 
-              /* add filters */
-              for (filt = options.common_data.filters; filt; filt = filt->next)
-                gtk_file_chooser_add_filter (GTK_FILE_CHOOSER (e), GTK_FILE_FILTER (filt->data));
+      /* add preview */
+      if (options.common_data.preview)
+        {
+          GtkWidget *p = gtk_image_new ();
+          gtk_file_chooser_set_preview_widget (GTK_FILE_CHOOSER (e), p);
+          g_signal_connect (e, "update-preview", G_CALLBACK (update_preview), p);
+        }
+
+      /* add filters */
+      for (filt = options.common_data.filters; filt; filt = filt->next)
+        gtk_file_chooser_add_filter (GTK_FILE_CHOOSER (e), GTK_FILE_FILTER (filt->data));
 
 #if !GTK_CHECK_VERSION(3,0,0)
-              gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
-                                GTK_EXPAND | GTK_FILL, 0, 5, 5);
+      gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
+                        GTK_EXPAND | GTK_FILL, 0, 5, 5);
 #else
-              gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
-              gtk_widget_set_hexpand (e, TRUE);
+      gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
+      gtk_widget_set_hexpand (e, TRUE);
 #endif
-              gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
-              fields = g_slist_append (fields, e);
-              break;
-
-            case YAD_FIELD_DIR:
-              e = gtk_file_chooser_button_new (_("Select folder"), GTK_FILE_CHOOSER_ACTION_SELECT_FOLDER);
-              gtk_widget_set_name (e, "yad-form-file");
-              if (fld->tip)
-                {
-                  if (!options.data.no_markup)
-                    gtk_widget_set_tooltip_markup (e, fld->tip);
-                  else
-                    gtk_widget_set_tooltip_text (e, fld->tip);
-                }
-              gtk_file_chooser_set_current_folder (GTK_FILE_CHOOSER (e), g_get_current_dir ());
+      gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
+      fields[i] = e;
+      break;
+
+    case YAD_FIELD_DIR:
+      e = gtk_file_chooser_button_new (_("Select folder"), GTK_FILE_CHOOSER_ACTION_SELECT_FOLDER);
+      gtk_widget_set_name (e, "yad-form-file");
+      if (fld->tip)
+        {
+          if (!options.data.no_markup)
+            gtk_widget_set_tooltip_markup (e, fld->tip);
+          else
+            gtk_widget_set_tooltip_text (e, fld->tip);
+        }
+      gtk_file_chooser_set_current_folder (GTK_FILE_CHOOSER (e), g_get_current_dir ());
 #if !GTK_CHECK_VERSION(3,0,0)
-              gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
-                                GTK_EXPAND | GTK_FILL, 0, 5, 5);
+      gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
+                        GTK_EXPAND | GTK_FILL, 0, 5, 5);
 #else
-              gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
-              gtk_widget_set_hexpand (e, TRUE);
+      gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
+      gtk_widget_set_hexpand (e, TRUE);
 #endif
-              gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
-              fields = g_slist_append (fields, e);
-              break;
-
-            case YAD_FIELD_FONT:
-              e = gtk_font_button_new ();
-              gtk_widget_set_name (e, "yad-form-font");
-              if (fld->tip)
-                {
-                  if (!options.data.no_markup)
-                    gtk_widget_set_tooltip_markup (e, fld->tip);
-                  else
-                    gtk_widget_set_tooltip_text (e, fld->tip);
-                }
+      gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
+      fields[i] = e;
+      break;
+
+    case YAD_FIELD_FONT:
+      e = gtk_font_button_new ();
+      gtk_widget_set_name (e, "yad-form-font");
+      if (fld->tip)
+        {
+          if (!options.data.no_markup)
+            gtk_widget_set_tooltip_markup (e, fld->tip);
+          else
+            gtk_widget_set_tooltip_text (e, fld->tip);
+        }
 #if !GTK_CHECK_VERSION(3,0,0)
-              gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
-                                GTK_EXPAND | GTK_FILL, 0, 5, 5);
+      gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
+                        GTK_EXPAND | GTK_FILL, 0, 5, 5);
 #else
-              gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
-              gtk_widget_set_hexpand (e, TRUE);
+      gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
+      gtk_widget_set_hexpand (e, TRUE);
 #endif
-              gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
-              fields = g_slist_append (fields, e);
-              break;
-
-            case YAD_FIELD_COLOR:
-              e = gtk_color_button_new ();
-              gtk_widget_set_name (e, "yad-form-color");
-              if (fld->tip)
-                {
-                  if (!options.data.no_markup)
-                    gtk_widget_set_tooltip_markup (e, fld->tip);
-                  else
-                    gtk_widget_set_tooltip_text (e, fld->tip);
-                }
+      gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
+      fields[i] = e;
+      break;
+
+    case YAD_FIELD_COLOR:
+      e = gtk_color_button_new ();
+      gtk_widget_set_name (e, "yad-form-color");
+      if (fld->tip)
+        {
+          if (!options.data.no_markup)
+            gtk_widget_set_tooltip_markup (e, fld->tip);
+          else
+            gtk_widget_set_tooltip_text (e, fld->tip);
+        }
 #if !GTK_CHECK_VERSION(3,0,0)
-              gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
-                                GTK_EXPAND | GTK_FILL, 0, 5, 5);
+      gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
+                        GTK_EXPAND | GTK_FILL, 0, 5, 5);
 #else
-              gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
-              gtk_widget_set_hexpand (e, TRUE);
+      gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
+      gtk_widget_set_hexpand (e, TRUE);
 #endif
-              gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
-              fields = g_slist_append (fields, e);
-              break;
-
-            case YAD_FIELD_MFILE:
-            case YAD_FIELD_MDIR:
-              e = gtk_entry_new ();
-              gtk_widget_set_name (e, "yad-form-entry");
-              if (fld->tip)
-                {
-                  if (!options.data.no_markup)
-                    gtk_widget_set_tooltip_markup (e, fld->tip);
-                  else
-                    gtk_widget_set_tooltip_text (e, fld->tip);
-                }
-              gtk_entry_set_icon_from_icon_name (GTK_ENTRY (e), GTK_ENTRY_ICON_SECONDARY, "document-open");
-              g_signal_connect (G_OBJECT (e), "icon-press", G_CALLBACK (select_files_cb), GINT_TO_POINTER (fld->type));
-              g_signal_connect (G_OBJECT (e), "activate", G_CALLBACK (form_activate_cb), dlg);
+      gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
+      fields[i] = e;
+      break;
+
+    case YAD_FIELD_MFILE:
+    case YAD_FIELD_MDIR:
+      e = gtk_entry_new ();
+      gtk_widget_set_name (e, "yad-form-entry");
+      if (fld->tip)
+        {
+          if (!options.data.no_markup)
+            gtk_widget_set_tooltip_markup (e, fld->tip);
+          else
+            gtk_widget_set_tooltip_text (e, fld->tip);
+        }
+      gtk_entry_set_icon_from_icon_name (GTK_ENTRY (e), GTK_ENTRY_ICON_SECONDARY, "document-open");
+      g_signal_connect (G_OBJECT (e), "icon-press", G_CALLBACK (select_files_cb), GINT_TO_POINTER (fld->type));
+      g_signal_connect (G_OBJECT (e), "activate", G_CALLBACK (form_activate_cb), dlg);
 #if !GTK_CHECK_VERSION(3,0,0)
-              gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
-                                GTK_EXPAND | GTK_FILL, 0, 5, 5);
+      gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
+                        GTK_EXPAND | GTK_FILL, 0, 5, 5);
 #else
-              gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
-              gtk_widget_set_hexpand (e, TRUE);
+      gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
+      gtk_widget_set_hexpand (e, TRUE);
 #endif
-              gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
-              fields = g_slist_append (fields, e);
-              break;
-
-            case YAD_FIELD_FILE_SAVE:
-            case YAD_FIELD_DIR_CREATE:
-              e = gtk_entry_new ();
-              gtk_widget_set_name (e, "yad-form-entry");
-              if (fld->tip)
-                {
-                  if (!options.data.no_markup)
-                    gtk_widget_set_tooltip_markup (e, fld->tip);
-                  else
-                    gtk_widget_set_tooltip_text (e, fld->tip);
-                }
-              gtk_entry_set_icon_from_icon_name (GTK_ENTRY (e), GTK_ENTRY_ICON_SECONDARY, "document-open");
-              g_signal_connect (G_OBJECT (e), "icon-press", G_CALLBACK (create_files_cb), GINT_TO_POINTER (fld->type));
-              g_signal_connect (G_OBJECT (e), "activate", G_CALLBACK (form_activate_cb), dlg);
+      gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
+      fields[i] = e;
+      break;
+
+    case YAD_FIELD_FILE_SAVE:
+    case YAD_FIELD_DIR_CREATE:
+      e = gtk_entry_new ();
+      gtk_widget_set_name (e, "yad-form-entry");
+      if (fld->tip)
+        {
+          if (!options.data.no_markup)
+            gtk_widget_set_tooltip_markup (e, fld->tip);
+          else
+            gtk_widget_set_tooltip_text (e, fld->tip);
+        }
+      gtk_entry_set_icon_from_icon_name (GTK_ENTRY (e), GTK_ENTRY_ICON_SECONDARY, "document-open");
+      g_signal_connect (G_OBJECT (e), "icon-press", G_CALLBACK (create_files_cb), GINT_TO_POINTER (fld->type));
+      g_signal_connect (G_OBJECT (e), "activate", G_CALLBACK (form_activate_cb), dlg);
 #if !GTK_CHECK_VERSION(3,0,0)
-              gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
-                                GTK_EXPAND | GTK_FILL, 0, 5, 5);
+      gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
+                        GTK_EXPAND | GTK_FILL, 0, 5, 5);
 #else
-              gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
-              gtk_widget_set_hexpand (e, TRUE);
+      gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
+      gtk_widget_set_hexpand (e, TRUE);
 #endif
-              gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
-              fields = g_slist_append (fields, e);
-              break;
-
-            case YAD_FIELD_DATE:
-              e = gtk_entry_new ();
-              gtk_widget_set_name (e, "yad-form-entry");
-              if (fld->tip)
-                {
-                  if (!options.data.no_markup)
-                    gtk_widget_set_tooltip_markup (e, fld->tip);
-                  else
-                    gtk_widget_set_tooltip_text (e, fld->tip);
-                }
-              pb = gdk_pixbuf_new_from_xpm_data (calendar_xpm);
-              gtk_entry_set_icon_from_pixbuf (GTK_ENTRY (e), GTK_ENTRY_ICON_SECONDARY, pb);
-              g_object_unref (pb);
-              g_signal_connect (G_OBJECT (e), "icon-press", G_CALLBACK (select_date_cb), e);
-              g_signal_connect (G_OBJECT (e), "activate", G_CALLBACK (form_activate_cb), dlg);
+      gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
+      fields[i] = e;
+      break;
+
+    case YAD_FIELD_DATE:
+      e = gtk_entry_new ();
+      gtk_widget_set_name (e, "yad-form-entry");
+      if (fld->tip)
+        {
+          if (!options.data.no_markup)
+            gtk_widget_set_tooltip_markup (e, fld->tip);
+          else
+            gtk_widget_set_tooltip_text (e, fld->tip);
+        }
+      pb = gdk_pixbuf_new_from_xpm_data (calendar_xpm);
+      gtk_entry_set_icon_from_pixbuf (GTK_ENTRY (e), GTK_ENTRY_ICON_SECONDARY, pb);
+      g_object_unref (pb);
+      g_signal_connect (G_OBJECT (e), "icon-press", G_CALLBACK (select_date_cb), e);
+      g_signal_connect (G_OBJECT (e), "activate", G_CALLBACK (form_activate_cb), dlg);
 #if !GTK_CHECK_VERSION(3,0,0)
-              gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
-                                GTK_EXPAND | GTK_FILL, 0, 5, 5);
+      gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
+                        GTK_EXPAND | GTK_FILL, 0, 5, 5);
 #else
-              gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
-              gtk_widget_set_hexpand (e, TRUE);
+      gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
+      gtk_widget_set_hexpand (e, TRUE);
 #endif
-              gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
-              fields = g_slist_append (fields, e);
-              break;
+      gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
+      fields[i] = e;
+      break;
 
-            case YAD_FIELD_SCALE:
+    case YAD_FIELD_SCALE:
 #if !GTK_CHECK_VERSION(3,0,0)
-              e = gtk_hscale_new_with_range (0.0, 100.0, 1.0);
+      e = gtk_hscale_new_with_range (0.0, 100.0, 1.0);
 #else
-              e = gtk_scale_new_with_range (GTK_ORIENTATION_HORIZONTAL, 0.0, 100.0, 1.0);
+      e = gtk_scale_new_with_range (GTK_ORIENTATION_HORIZONTAL, 0.0, 100.0, 1.0);
 #endif
-              gtk_widget_set_name (e, "yad-form-scale");
-              if (fld->tip)
-                {
-                  if (!options.data.no_markup)
-                    gtk_widget_set_tooltip_markup (e, fld->tip);
-                  else
-                    gtk_widget_set_tooltip_text (e, fld->tip);
-                }
-              gtk_scale_set_value_pos (GTK_SCALE (e), GTK_POS_LEFT);
+      gtk_widget_set_name (e, "yad-form-scale");
+      if (fld->tip)
+        {
+          if (!options.data.no_markup)
+            gtk_widget_set_tooltip_markup (e, fld->tip);
+          else
+            gtk_widget_set_tooltip_text (e, fld->tip);
+        }
+      gtk_scale_set_value_pos (GTK_SCALE (e), GTK_POS_LEFT);
 #if !GTK_CHECK_VERSION(3,0,0)
-              gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
-                                GTK_EXPAND | GTK_FILL, 0, 5, 5);
+      gtk_table_attach (GTK_TABLE (tbl), e, 1 + col * 2, 2 + col * 2, row, row + 1,
+                        GTK_EXPAND | GTK_FILL, 0, 5, 5);
 #else
-              gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
-              gtk_widget_set_hexpand (e, TRUE);
+      gtk_grid_attach (GTK_GRID (tbl), e, 1 + col * 2, row, 1, 1);
+      gtk_widget_set_hexpand (e, TRUE);
 #endif
-              gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
-              fields = g_slist_append (fields, e);
-              break;
-
-            case YAD_FIELD_BUTTON:
-            case YAD_FIELD_FULL_BUTTON:
-              e = gtk_button_new ();
-              gtk_widget_set_name (e, "yad-form-button");
-              if (fld->tip)
-                {
-                  if (!options.data.no_markup)
-                    gtk_widget_set_tooltip_markup (e, fld->tip);
-                  else
-                    gtk_widget_set_tooltip_text (e, fld->tip);
-                }
-              g_signal_connect (G_OBJECT (e), "clicked", G_CALLBACK (button_clicked_cb), NULL);
-              l = get_label (fld->name, 2, e);
-              gtk_container_add (GTK_CONTAINER (e), l);
-              if (options.form_data.align_buttons)
-                UNDEPR (gtk_button_set_alignment, GTK_BUTTON (e), options.common_data.align, 0.5);
-              if (fld->type == YAD_FIELD_BUTTON)
-                gtk_button_set_relief (GTK_BUTTON (e), GTK_RELIEF_NONE);
+      gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
+      fields[i] = e;
+      break;
+
+    case YAD_FIELD_BUTTON:
+    case YAD_FIELD_FULL_BUTTON:
+      e = gtk_button_new ();
+      gtk_widget_set_name (e, "yad-form-button");
+      if (fld->tip)
+        {
+          if (!options.data.no_markup)
+            gtk_widget_set_tooltip_markup (e, fld->tip);
+          else
+            gtk_widget_set_tooltip_text (e, fld->tip);
+        }
+      g_signal_connect (G_OBJECT (e), "clicked", G_CALLBACK (button_clicked_cb), NULL);
+      l = get_label (fld->name, 2, e);
+      gtk_container_add (GTK_CONTAINER (e), l);
+      if (options.form_data.align_buttons)
+        UNDEPR (gtk_button_set_alignment, GTK_BUTTON (e), options.common_data.align, 0.5);
+      if (fld->type == YAD_FIELD_BUTTON)
+        gtk_button_set_relief (GTK_BUTTON (e), GTK_RELIEF_NONE);
 #if !GTK_CHECK_VERSION(3,0,0)
-              gtk_table_attach (GTK_TABLE (tbl), e, col * 2, 2 + col * 2, row, row + 1, GTK_EXPAND | GTK_FILL, 0, 5, 5);
+      gtk_table_attach (GTK_TABLE (tbl), e, col * 2, 2 + col * 2, row, row + 1, GTK_EXPAND | GTK_FILL, 0, 5, 5);
 #else
-              gtk_grid_attach (GTK_GRID (tbl), e, col * 2, row, 2, 1);
-              gtk_widget_set_hexpand (e, TRUE);
+      gtk_grid_attach (GTK_GRID (tbl), e, col * 2, row, 2, 1);
+      gtk_widget_set_hexpand (e, TRUE);
 #endif
-              fields = g_slist_append (fields, e);
-              break;
+      fields[i] = e;
+      break;
 
-            case YAD_FIELD_LINK:
-              {
-                gchar *buf;
-                if (fld->name)
-                  buf = g_strdup (fld->name[0] ? fld->name : _("Link"));
-                else
-                  buf = g_strdup (_("Link"));
-
-                e = gtk_link_button_new_with_label ("", buf);
-                gtk_widget_set_name (e, "yad-form-link");
-                if (fld->tip)
-                  {
-                    if (!options.data.no_markup)
-                      gtk_widget_set_tooltip_markup (e, fld->tip);
-                    else
-                      gtk_widget_set_tooltip_text (e, fld->tip);
-                  }
+    case YAD_FIELD_LINK:
+      {
+        gchar *buf;
+        if (fld->name)
+          buf = g_strdup (fld->name[0] ? fld->name : _("Link"));
+        else
+          buf = g_strdup (_("Link"));
+
+        e = gtk_link_button_new_with_label ("", buf);
+        gtk_widget_set_name (e, "yad-form-link");
+        if (fld->tip)
+          {
+            if (!options.data.no_markup)
+              gtk_widget_set_tooltip_markup (e, fld->tip);
+            else
+              gtk_widget_set_tooltip_text (e, fld->tip);
+          }
 #if !GTK_CHECK_VERSION(3,0,0)
-                gtk_link_button_set_uri_hook ((GtkLinkButtonUriFunc) link_clicked_no_op, NULL, NULL);
-                g_signal_connect (G_OBJECT (e), "clicked", G_CALLBACK (link_clicked_cb), NULL);
-                gtk_table_attach (GTK_TABLE (tbl), e, col * 2, 2 + col * 2, row, row + 1, GTK_EXPAND | GTK_FILL, 0, 5, 5);
+        gtk_link_button_set_uri_hook ((GtkLinkButtonUriFunc) link_clicked_no_op, NULL, NULL);
+        g_signal_connect (G_OBJECT (e), "clicked", G_CALLBACK (link_clicked_cb), NULL);
+        gtk_table_attach (GTK_TABLE (tbl), e, col * 2, 2 + col * 2, row, row + 1, GTK_EXPAND | GTK_FILL, 0, 5, 5);
 #else
-                g_signal_connect (G_OBJECT (e), "activate-link", G_CALLBACK (link_clicked_cb), NULL);
-                gtk_grid_attach (GTK_GRID (tbl), e, col * 2, row, 2, 1);
-                gtk_widget_set_hexpand (e, TRUE);
+        g_signal_connect (G_OBJECT (e), "activate-link", G_CALLBACK (link_clicked_cb), NULL);
+        gtk_grid_attach (GTK_GRID (tbl), e, col * 2, row, 2, 1);
+        gtk_widget_set_hexpand (e, TRUE);
 #endif
-                fields = g_slist_append (fields, e);
-                g_free (buf);
-                break;
-              }
+        fields[i] = e;
+        g_free (buf);
+        break;
+      }
 
-            case YAD_FIELD_LABEL:
-              if (fld->name && fld->name[0])
-                {
-                  gchar *buf = g_strcompress (fld->name);
-                  e = gtk_label_new (NULL);
-                  gtk_widget_set_name (e, "yad-form-label");
-                  if (fld->tip)
-                    {
-                      if (!options.data.no_markup)
-                        gtk_widget_set_tooltip_markup (e, fld->tip);
-                      else
-                        gtk_widget_set_tooltip_text (e, fld->tip);
-                    }
-                  if (options.data.no_markup)
-                    gtk_label_set_text (GTK_LABEL (e), buf);
-                  else
-                    gtk_label_set_markup (GTK_LABEL (e), buf);
-                  gtk_label_set_line_wrap (GTK_LABEL (e), TRUE);
-                  gtk_label_set_selectable (GTK_LABEL (e), options.data.selectable_labels);
+    case YAD_FIELD_LABEL:
+      if (fld->name && fld->name[0])
+        {
+          gchar *buf = g_strcompress (fld->name);
+          e = gtk_label_new (NULL);
+          gtk_widget_set_name (e, "yad-form-label");
+          if (fld->tip)
+            {
+              if (!options.data.no_markup)
+                gtk_widget_set_tooltip_markup (e, fld->tip);
+              else
+                gtk_widget_set_tooltip_text (e, fld->tip);
+            }
+          if (options.data.no_markup)
+            gtk_label_set_text (GTK_LABEL (e), buf);
+          else
+            gtk_label_set_markup (GTK_LABEL (e), buf);
+          gtk_label_set_line_wrap (GTK_LABEL (e), TRUE);
+          gtk_label_set_selectable (GTK_LABEL (e), options.data.selectable_labels);
 #if !GTK_CHECK_VERSION(3,0,0)
-                  gtk_misc_set_alignment (GTK_MISC (e), options.common_data.align, 0.5);
+          gtk_misc_set_alignment (GTK_MISC (e), options.common_data.align, 0.5);
 #else
-                  gtk_label_set_xalign (GTK_LABEL (e), options.common_data.align);
+          gtk_label_set_xalign (GTK_LABEL (e), options.common_data.align);
 #endif
-                  g_free (buf);
-                }
-              else
-                {
+          g_free (buf);
+        }
+      else
+        {
 #if GTK_CHECK_VERSION(3,0,0)
-                  e = gtk_separator_new (GTK_ORIENTATION_HORIZONTAL);
+          e = gtk_separator_new (GTK_ORIENTATION_HORIZONTAL);
 #else
-                  e = gtk_hseparator_new ();
+          e = gtk_hseparator_new ();
 #endif
-                  gtk_widget_set_name (e, "yad-form-separator");
-                }
+          gtk_widget_set_name (e, "yad-form-separator");
+        }
 #if !GTK_CHECK_VERSION(3,0,0)
-              gtk_table_attach (GTK_TABLE (tbl), e, col * 2, 2 + col * 2, row, row + 1, GTK_EXPAND | GTK_FILL, 0, 5, 5);
+      gtk_table_attach (GTK_TABLE (tbl), e, col * 2, 2 + col * 2, row, row + 1, GTK_EXPAND | GTK_FILL, 0, 5, 5);
 #else
-              gtk_grid_attach (GTK_GRID (tbl), e, col * 2, row, 2, 1);
-              gtk_widget_set_hexpand (e, TRUE);
+      gtk_grid_attach (GTK_GRID (tbl), e, col * 2, row, 2, 1);
+      gtk_widget_set_hexpand (e, TRUE);
 #endif
-              fields = g_slist_append (fields, e);
-              break;
+      fields[i] = e;
+      break;
 
-            case YAD_FIELD_TEXT:
-              {
-                GtkWidget *sw, *b;
-                gchar *ltxt;
+    case YAD_FIELD_TEXT:
+      {
+        GtkWidget *sw, *b;
+        gchar *ltxt;
 
-                if (fld->name)
-                  ltxt = g_strcompress (fld->name);
-                else
-                  ltxt = g_strdup ("");
+        if (fld->name)
+          ltxt = g_strcompress (fld->name);
+        else
+          ltxt = g_strdup ("");
 
 #if !GTK_CHECK_VERSION(3,0,0)
-                b = gtk_vbox_new (FALSE, 2);
+        b = gtk_vbox_new (FALSE, 2);
 #else
-                b = gtk_box_new (GTK_ORIENTATION_VERTICAL, 2);
+        b = gtk_box_new (GTK_ORIENTATION_VERTICAL, 2);
 #endif
 
-                l = gtk_label_new ("");
+        l = gtk_label_new ("");
 
 #if !GTK_CHECK_VERSION(3,0,0)
-                gtk_misc_set_alignment (GTK_MISC (l), 0.0, 0.5);
+        gtk_misc_set_alignment (GTK_MISC (l), 0.0, 0.5);
 #else
-                gtk_label_set_xalign (GTK_LABEL (l), 0.0);
+        gtk_label_set_xalign (GTK_LABEL (l), 0.0);
 #endif
-                if (options.data.no_markup)
-                  gtk_label_set_text (GTK_LABEL (l), ltxt);
-                else
-                  gtk_label_set_markup (GTK_LABEL (l), ltxt);
-                g_free (ltxt);
-                gtk_box_pack_start (GTK_BOX (b), l, FALSE, FALSE, 0);
-
-                sw = gtk_scrolled_window_new (NULL, NULL);
-                gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (sw), GTK_SHADOW_ETCHED_IN);
-                gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (sw), options.hscroll_policy, options.vscroll_policy);
-                gtk_box_pack_start (GTK_BOX (b), sw, TRUE, TRUE, 0);
-
-                e = gtk_text_view_new ();
-                gtk_widget_set_name (e, "yad-form-text");
-                if (fld->tip)
-                  {
-                    if (!options.data.no_markup)
-                      gtk_widget_set_tooltip_markup (e, fld->tip);
-                    else
-                      gtk_widget_set_tooltip_text (e, fld->tip);
-                  }
-                gtk_text_view_set_editable (GTK_TEXT_VIEW (e), TRUE);
-                gtk_text_view_set_wrap_mode (GTK_TEXT_VIEW (e), GTK_WRAP_WORD_CHAR);
-                gtk_container_add (GTK_CONTAINER (sw), e);
+        if (options.data.no_markup)
+          gtk_label_set_text (GTK_LABEL (l), ltxt);
+        else
+          gtk_label_set_markup (GTK_LABEL (l), ltxt);
+        g_free (ltxt);
+        gtk_box_pack_start (GTK_BOX (b), l, FALSE, FALSE, 0);
+
+        sw = gtk_scrolled_window_new (NULL, NULL);
+        gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (sw), GTK_SHADOW_ETCHED_IN);
+        gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (sw), options.hscroll_policy, options.vscroll_policy);
+        gtk_box_pack_start (GTK_BOX (b), sw, TRUE, TRUE, 0);
+
+        e = gtk_text_view_new ();
+        gtk_widget_set_name (e, "yad-form-text");
+        if (fld->tip)
+          {
+            if (!options.data.no_markup)
+              gtk_widget_set_tooltip_markup (e, fld->tip);
+            else
+              gtk_widget_set_tooltip_text (e, fld->tip);
+          }
+        gtk_text_view_set_editable (GTK_TEXT_VIEW (e), TRUE);
+        gtk_text_view_set_wrap_mode (GTK_TEXT_VIEW (e), GTK_WRAP_WORD_CHAR);
+        gtk_container_add (GTK_CONTAINER (sw), e);
 
 #ifdef HAVE_SPELL
-                if (options.common_data.enable_spell)
-                  {
-                    GtkSpellChecker *spell = gtk_spell_checker_new ();
-                    gtk_spell_checker_set_language (spell, options.common_data.spell_lang, NULL);
-                    gtk_spell_checker_attach (spell, GTK_TEXT_VIEW (e));
-                  }
+        if (options.common_data.enable_spell)
+          {
+            GtkSpellChecker *spell = gtk_spell_checker_new ();
+            gtk_spell_checker_set_language (spell, options.common_data.spell_lang, NULL);
+            gtk_spell_checker_attach (spell, GTK_TEXT_VIEW (e));
+          }
 #endif
 
 #if !GTK_CHECK_VERSION(3,0,0)
-                gtk_table_attach (GTK_TABLE (tbl), b, col * 2, 2 + col * 2, row, row + 1,
-                                  GTK_EXPAND | GTK_FILL, GTK_EXPAND | GTK_FILL, 5, 5);
+        gtk_table_attach (GTK_TABLE (tbl), b, col * 2, 2 + col * 2, row, row + 1,
+                          GTK_EXPAND | GTK_FILL, GTK_EXPAND | GTK_FILL, 5, 5);
 #else
-                gtk_grid_attach (GTK_GRID (tbl), b, col * 2, row, 2, 1);
-                gtk_widget_set_hexpand (b, TRUE);
-                gtk_widget_set_vexpand (b, TRUE);
+        gtk_grid_attach (GTK_GRID (tbl), b, col * 2, row, 2, 1);
+        gtk_widget_set_hexpand (b, TRUE);
+        gtk_widget_set_vexpand (b, TRUE);
 #endif
-                gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
-                fields = g_slist_append (fields, e);
+        gtk_label_set_mnemonic_widget (GTK_LABEL (l), e);
+        fields[i] = e;
 
-                break;
-              }
+        break;
+      }
+    }
+
+  if (lazy_fields)
+    {
+      GtkWidget *top = e;
+
+      /* window is already shown */
+      while (gtk_widget_get_parent (top) != tbl)
+        top = gtk_widget_get_parent (top);
+      gtk_widget_show_all (top);
+      if (l && gtk_widget_get_parent (l) == tbl)
+        gtk_widget_show_all (l);
+    }
+
+  if (pending_values && pending_values[i])
+    {
+      gboolean dc = disable_changed;
+
+      disable_changed = TRUE;
+      set_field_value (i, pending_values[i]);
+      g_free (pending_values[i]);
+      pending_values[i] = NULL;
+      disable_changed = dc;
+    }
+}
+
+static gboolean
+create_fields_idle (gpointer data)
+{
+  guint n = 0;
+
+  while (next_field < n_fields && n < FORM_LAZY_BATCH)
+    {
+      if (fields[next_field] == NULL)
+        {
+          create_field (next_field);
+          n++;
+        }
+      next_field++;
+    }
+
+  if (next_field < n_fields)
+    return TRUE;
+
+  g_free (pending_values);
+  pending_values = NULL;
+  return FALSE;
+}
+
+static GtkWidget *
+get_field (guint num)
+{
+  if (fields[num] == NULL)
+    create_field (num);
+  return fields[num];
+}
+
+/* field index by number or @atid, -1 if not found */
+static gint
+get_field_num (const gchar *key)
+{
+  if (g_ascii_isdigit (*key))
+    {
+      gint num = atoi (key);
+      return (num > 0 && num <= n_fields) ? num - 1 : -1;
+    }
+  else if (*key == '@')
+    return GPOINTER_TO_INT (g_hash_table_lookup (field_atids, key)) - 1;
+
+  return -1;
+}
+
+static GPtrArray *keyed_batch = NULL;
+
+static void
+apply_keyed_batch ()
+{
+  guint i;
+
+  disable_changed = TRUE;
+  for (i = 0; i < keyed_batch->len; i++)
+    {
+      gchar *line = g_ptr_array_index (keyed_batch, i);
+      gchar *val = strchr (line, ':');
+
+      if (val)
+        {
+          gint num;
+
+          *val = '\0';
+          num = get_field_num (line);
+          if (num >= 0)
+            set_field_value (num, val + 1);
+        }
+      g_free (line);
+    }
+  g_ptr_array_set_size (keyed_batch, 0);
+  disable_changed = FALSE;
+}
+
+/* lines N:VALUE or @ATID:VALUE, empty line applies collected values at once */
+static gboolean
+handle_keyed_stdin (GIOChannel * ch, GIOCondition cond, gpointer data)
+{
+  if ((cond == G_IO_IN) || (cond == G_IO_IN + G_IO_HUP))
+    {
+      GError *err = NULL;
+      GString *string = g_string_new (NULL);
+      gint status;
+
+      while (ch->is_readable != TRUE);
+
+      do
+        {
+          gchar *ptr;
+
+          status = g_io_channel_read_line_string (ch, string, NULL, &err);
+          if (status != G_IO_STATUS_NORMAL)
+            break;
+
+          strip_new_line (string->str);
+          ptr = string->str;
+          while (isblank (*ptr))
+            ptr++;
+
+          if (*ptr == '\0')
+            apply_keyed_batch ();
+          else if (*ptr == '\014')
+            {
+              gint i;
+
+              /* clear the form */
+              g_ptr_array_set_size (keyed_batch, 0);
+              disable_changed = TRUE;
+              for (i = 0; i < n_fields; i++)
+                set_field_value (i, "");
+              disable_changed = FALSE;
             }
+          else
+            g_ptr_array_add (keyed_batch, g_strdup (ptr));
+        }
+      while (g_io_channel_get_buffer_condition (ch) == G_IO_IN);
+      g_string_free (string, TRUE);
 
-          /* increase row and column */
-          row++;
-          if (row >= rows)
+      if (status == G_IO_STATUS_ERROR || status == G_IO_STATUS_EOF)
+        {
+          if (err)
             {
-              row = 0;
-              col++;
+              g_printerr ("yad_form_handle_stdin(): %s\n", err->message);
+              g_error_free (err);
             }
+          apply_keyed_batch ();
+          g_io_channel_shutdown (ch, TRUE, NULL);
+          return FALSE;
         }
+    }
+
+  if ((cond != G_IO_IN) && (cond != G_IO_IN + G_IO_HUP))
+    {
+      apply_keyed_batch ();
+      g_io_channel_shutdown (ch, TRUE, NULL);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+GtkWidget *
+form_create_widget (GtkWidget * dlg)
+{
+  GtkWidget *tbl, *w = NULL;
+
+  if (options.form_data.fields)
+    {
+      GSList *f;
+      guint i;
+
+      n_fields = g_slist_length (options.form_data.fields);
+
+      fields = g_new0 (GtkWidget *, n_fields);
+      field_data = g_new0 (YadField *, n_fields);
+      field_atids = g_hash_table_new (g_str_hash, g_str_equal);
+      for (f = options.form_data.fields, i = 0; f; f = f->next, i++)
+        {
+          field_data[i] = (YadField *) f->data;
+          if (field_data[i]->atid)
+            g_hash_table_insert (field_atids, field_data[i]->atid, GINT_TO_POINTER (i + 1));
+        }
+
+      form_rows = n_fields / options.form_data.columns;
+      if (n_fields % options.form_data.columns > 0)
+        form_rows++;
+
+#if !GTK_CHECK_VERSION(3,0,0)
+      tbl = gtk_table_new (n_fields, 2 * options.form_data.columns, FALSE);
+#else
+      tbl = gtk_grid_new ();
+      gtk_grid_set_row_spacing (GTK_GRID (tbl), 5);
+      gtk_grid_set_column_spacing (GTK_GRID (tbl), 5);
+      gtk_grid_set_row_homogeneous (GTK_GRID (tbl), options.form_data.homogeneous);
+#endif
+      form_table = tbl;
+      form_dialog = dlg;
+
+      if (options.common_data.scroll)
+        {
+          GtkWidget *sw = gtk_scrolled_window_new (NULL, NULL);
+          gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (sw), GTK_SHADOW_NONE);
+          gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (sw), options.hscroll_policy, options.vscroll_policy);
+
+
+#if !GTK_CHECK_VERSION(3,0,0)
+          gtk_scrolled_window_add_with_viewport (GTK_SCROLLED_WINDOW (sw), tbl);
+#else
+          gtk_container_add (GTK_CONTAINER (sw), tbl);
+#endif
+          w = sw;
+
+          /* big scrollable forms are filled in background */
+          lazy_fields = (n_fields > FORM_LAZY_FIELDS);
+        }
+      else
+        w = tbl;
+
+      /* create form */
+      if (lazy_fields)
+        {
+          pending_values = g_new0 (gchar *, n_fields);
+          for (i = 0; i < FORM_LAZY_FIELDS; i++)
+            create_field (i);
+          next_field = FORM_LAZY_FIELDS;
+          g_idle_add (create_fields_idle, NULL);
+        }
+      else
+        {
+          for (i = 0; i < n_fields; i++)
+            create_field (i);
+        }
+
+      if (options.form_data.changed_action)
+        changed_action = compile_action (options.form_data.changed_action);
 
       /* fill entries with data */
       if (options.extra_data)
@@ -1556,12 +2086,18 @@ form_create_widget (GtkWidget * dlg)
           GIOChannel *channel = g_io_channel_unix_new (0);
           g_io_channel_set_encoding (channel, NULL, NULL);
           g_io_channel_set_flags (channel, G_IO_FLAG_NONBLOCK, NULL);
-          g_io_add_watch (channel, G_IO_IN | G_IO_HUP, handle_stdin, NULL);
+          if (options.form_data.keyed_input)
+            {
+              keyed_batch = g_ptr_array_new ();
+              g_io_add_watch (channel, G_IO_IN | G_IO_HUP, handle_keyed_stdin, NULL);
+            }
+          else
+            g_io_add_watch (channel, G_IO_IN | G_IO_HUP, handle_stdin, NULL);
         }
     }
 
   if (options.form_data.focus_field > 0 && options.form_data.focus_field <= n_fields)
-    gtk_widget_grab_focus (GTK_WIDGET (g_slist_nth_data (fields, options.form_data.focus_field - 1)));
+    gtk_widget_grab_focus (get_field (options.form_data.focus_field - 1));
 
   disable_changed = FALSE;
 
@@ -1573,7 +2109,7 @@ form_print_field (guint fn)
 {
   gchar *buf, *lhs;
   static GRegex *regex;
-  YadField *fld = g_slist_nth_data (options.form_data.fields, fn);
+  YadField *fld = field_data[fn];
 
   if (options.form_data.use_output_prefix)
     {
@@ -1598,22 +2134,22 @@ form_print_field (guint fn)
     case YAD_FIELD_DATE:
       if (options.common_data.quoted_output)
         {
-          buf = g_shell_quote (gtk_entry_get_text (GTK_ENTRY (g_slist_nth_data (fields, fn))));
+          buf = g_shell_quote (gtk_entry_get_text (GTK_ENTRY (get_field (fn))));
           g_printf ("%s%s%s", lhs, buf, options.common_data.separator);
           g_free (buf);
         }
       else
-        g_printf ("%s%s%s", lhs, gtk_entry_get_text (GTK_ENTRY (g_slist_nth_data (fields, fn))),
+        g_printf ("%s%s%s", lhs, gtk_entry_get_text (GTK_ENTRY (get_field (fn))),
                   options.common_data.separator);
       break;
     case YAD_FIELD_NUM:
       {
-        guint prec = gtk_spin_button_get_digits (GTK_SPIN_BUTTON (g_slist_nth_data (fields, fn)));
+        guint prec = gtk_spin_button_get_digits (GTK_SPIN_BUTTON (get_field (fn)));
         if (options.common_data.quoted_output)
-          g_printf ("%s'%.*f'%s", lhs, prec, gtk_spin_button_get_value (GTK_SPIN_BUTTON (g_slist_nth_data (fields, fn))),
+          g_printf ("%s'%.*f'%s", lhs, prec, gtk_spin_button_get_value (GTK_SPIN_BUTTON (get_field (fn))),
                     options.common_data.separator);
         else
-          g_printf ("%s%.*f%s", lhs, prec, gtk_spin_button_get_value (GTK_SPIN_BUTTON (g_slist_nth_data (fields, fn))),
+          g_printf ("%s%.*f%s", lhs, prec, gtk_spin_button_get_value (GTK_SPIN_BUTTON (get_field (fn))),
                     options.common_data.separator);
         break;
       }
@@ -1622,42 +2158,42 @@ form_print_field (guint fn)
 #endif
     case YAD_FIELD_CHECK:
       if (options.common_data.quoted_output)
-        g_printf ("%s'%s'%s", lhs, print_bool_val (gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (g_slist_nth_data (fields, fn)))),
+        g_printf ("%s'%s'%s", lhs, print_bool_val (gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (get_field (fn)))),
                   options.common_data.separator);
       else
-        g_printf ("%s%s%s", lhs, print_bool_val (gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (g_slist_nth_data (fields, fn)))),
+        g_printf ("%s%s%s", lhs, print_bool_val (gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (get_field (fn)))),
                   options.common_data.separator);
       break;
 #if GTK_CHECK_VERSION(3,0,0)
     case YAD_FIELD_SWITCH:
       if (options.common_data.quoted_output)
-        g_printf ("%s'%s'%s", lhs, print_bool_val (gtk_switch_get_state (GTK_SWITCH (g_slist_nth_data (fields, fn)))),
+        g_printf ("%s'%s'%s", lhs, print_bool_val (gtk_switch_get_state (GTK_SWITCH (get_field (fn)))),
                   options.common_data.separator);
       else
-        g_printf ("%s%s%s", lhs, print_bool_val (gtk_switch_get_state (GTK_SWITCH (g_slist_nth_data (fields, fn)))),
+        g_printf ("%s%s%s", lhs, print_bool_val (gtk_switch_get_state (GTK_SWITCH (get_field (fn)))),
                   options.common_data.separator);
       break;
 #endif
     case YAD_FIELD_COMBO:
     case YAD_FIELD_COMBO_ENTRY:
       if (options.common_data.num_output && fld->type == YAD_FIELD_COMBO)
-        g_printf ("%s%d%s", lhs, gtk_combo_box_get_active (GTK_COMBO_BOX (g_slist_nth_data (fields, fn))) + 1,
+        g_printf ("%s%d%s", lhs, combo_get_active (get_field (fn)) + 1,
                   options.common_data.separator);
       else if (options.common_data.quoted_output)
         {
-          buf = g_shell_quote (gtk_combo_box_text_get_active_text (GTK_COMBO_BOX_TEXT (g_slist_nth_data (fields, fn))));
+          buf = g_shell_quote (gtk_combo_box_text_get_active_text (GTK_COMBO_BOX_TEXT (get_field (fn))));
           g_printf ("%s%s%s", lhs, buf, options.common_data.separator);
           g_free (buf);
         }
       else
-        g_printf ("%s%s%s", lhs, gtk_combo_box_text_get_active_text (GTK_COMBO_BOX_TEXT (g_slist_nth_data (fields, fn))),
+        g_printf ("%s%s%s", lhs, gtk_combo_box_text_get_active_text (GTK_COMBO_BOX_TEXT (get_field (fn))),
                   options.common_data.separator);
       break;
     case YAD_FIELD_FILE:
     case YAD_FIELD_DIR:
       if (options.common_data.quoted_output)
         {
-          gchar *fname = gtk_file_chooser_get_filename (GTK_FILE_CHOOSER (g_slist_nth_data (fields, fn)));
+          gchar *fname = gtk_file_chooser_get_filename (GTK_FILE_CHOOSER (get_field (fn)));
           buf = g_shell_quote (fname ? fname : "");
           g_free (fname);
           g_printf ("%s%s%s", lhs, buf ? buf : "", options.common_data.separator);
@@ -1665,7 +2201,7 @@ form_print_field (guint fn)
         }
       else
         {
-          buf = gtk_file_chooser_get_filename (GTK_FILE_CHOOSER (g_slist_nth_data (fields, fn)));
+          buf = gtk_file_chooser_get_filename (GTK_FILE_CHOOSER (get_field (fn)));
           g_printf ("%s%s%s", lhs, buf ? buf : "", options.common_data.separator);
           g_free (buf);
         }
@@ -1674,9 +2210,9 @@ form_print_field (guint fn)
       {
         gchar *fname;
 #if !GTK_CHECK_VERSION(3,2,0)
-        fname = (gchar *) gtk_font_button_get_font_name (GTK_FONT_BUTTON (g_slist_nth_data (fields, fn)));
+        fname = (gchar *) gtk_font_button_get_font_name (GTK_FONT_BUTTON (get_field (fn)));
 #else
-        fname = gtk_font_chooser_get_font (GTK_FONT_CHOOSER (g_slist_nth_data (fields, fn)));
+        fname = gtk_font_chooser_get_font (GTK_FONT_CHOOSER (get_field (fn)));
 #endif
         if (options.common_data.quoted_output)
           g_printf ("%s'%s'%s", lhs, fname ? fname : "", options.common_data.separator);
@@ -1690,12 +2226,12 @@ form_print_field (guint fn)
         gchar *cs;
 #if !GTK_CHECK_VERSION(3,4,0)
         GdkColor c;
-        GtkColorButton *cb = GTK_COLOR_BUTTON (g_slist_nth_data (fields, fn));
+        GtkColorButton *cb = GTK_COLOR_BUTTON (get_field (fn));
         gtk_color_button_get_color (cb, &c);
         cs = get_color (&c, gtk_color_button_get_alpha (cb));
 #else
         GdkRGBA c;
-        GtkColorChooser *cb = GTK_COLOR_CHOOSER (g_slist_nth_data (fields, fn));
+        GtkColorChooser *cb = GTK_COLOR_CHOOSER (get_field (fn));
         gtk_color_chooser_get_rgba (cb, &c);
         cs = get_color (&c);
 #endif
@@ -1712,21 +2248,21 @@ form_print_field (guint fn)
       }
     case YAD_FIELD_SCALE:
       if (options.common_data.quoted_output)
-        g_printf ("%s'%d'%s", lhs, (gint) gtk_range_get_value (GTK_RANGE (g_slist_nth_data (fields, fn))),
+        g_printf ("%s'%d'%s", lhs, (gint) gtk_range_get_value (GTK_RANGE (get_field (fn))),
                   options.common_data.separator);
       else
-        g_printf ("%s%d%s", lhs, (gint) gtk_range_get_value (GTK_RANGE (g_slist_nth_data (fields, fn))),
+        g_printf ("%s%d%s", lhs, (gint) gtk_range_get_value (GTK_RANGE (get_field (fn))),
                   options.common_data.separator);
       break;
     case YAD_FIELD_LINK:
       if (options.common_data.quoted_output)
         {
-          buf = g_shell_quote (gtk_link_button_get_uri (GTK_LINK_BUTTON (g_slist_nth_data (fields, fn))));
+          buf = g_shell_quote (gtk_link_button_get_uri (GTK_LINK_BUTTON (get_field (fn))));
           g_printf ("%s%s%s", lhs, buf, options.common_data.separator);
           g_free (buf);
         }
       else
-        g_printf ("%s%s%s", lhs, gtk_link_button_get_uri (GTK_LINK_BUTTON (g_slist_nth_data (fields, fn))),
+        g_printf ("%s%s%s", lhs, gtk_link_button_get_uri (GTK_LINK_BUTTON (get_field (fn))),
                   options.common_data.separator);
       break;
     case YAD_FIELD_BUTTON:
@@ -1743,7 +2279,7 @@ form_print_field (guint fn)
         GtkTextBuffer *tb;
         GtkTextIter b, e;
 
-        tb = gtk_text_view_get_buffer (GTK_TEXT_VIEW (g_slist_nth_data (fields, fn)));
+        tb = gtk_text_view_get_buffer (GTK_TEXT_VIEW (get_field (fn)));
         gtk_text_buffer_get_bounds (tb, &b, &e);
         txt = escape_str (gtk_text_buffer_get_text (tb, &b, &e, FALSE));
         if (options.common_data.quoted_output)
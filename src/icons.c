@@ -17,11 +17,51 @@
  * Copyright (C) 2008-2019, Victor Ananjevsky <ananasik@gmail.com>
  */
 
+#include <string.h>
+#include <glib/gstdio.h>
+
 #include "yad.h"
 
 static GtkWidget *icon_view;
 static GtkListStore *store;
 
+/* icon sizes for compact and full mode */
+static gint small_width, small_height;
+static gint big_size;
+
+/* directory scanning */
+static GThreadPool *scan_pool = NULL;
+static volatile gint scan_gen = 0;
+static GPtrArray *scan_results = NULL;
+static guint scan_idle = 0;
+
+/* desktop file name => row reference */
+static GHashTable *dir_rows = NULL;
+
+/* on-disk cache of parsed entries and scaled icons */
+#define ICONS_CACHE_VERSION 1
+#define ICONS_CACHE_ENTRY "(sxtsssb(biiiay))"
+
+typedef struct {
+  gint64 mtime;
+  guint64 size;
+} FileStat;
+
+static GHashTable *file_stats = NULL;   /* desktop file name => FileStat */
+static gchar *cache_file = NULL;
+static guint scan_pending = 0;
+static gboolean cache_dirty = FALSE;
+
+#ifdef HAVE_GIO
+#define MONITOR_DELAY 200
+
+/* names of changed files waiting for update */
+static GHashTable *changed_files = NULL;
+static guint changed_timeout = 0;
+#endif
+
+G_LOCK_DEFINE_STATIC (scan_lock);
+
 enum {
   COL_FILENAME = 0,
   COL_NAME,
@@ -40,11 +80,22 @@ enum {
 typedef struct {
   gchar *name;
   gchar *comment;
+  gchar *icon;
   GdkPixbuf *pixbuf;
   gchar *command;
   gboolean in_term;
 } DEntry;
 
+/* job for scanning thread. parses desktop file or decodes icon for existing row */
+typedef struct {
+  gint gen;
+  gchar *filename;
+  gchar *path;
+  GtkTreeRowReference *row;
+  DEntry *ent;
+  GdkPixbuf *pixbuf;
+} ScanJob;
+
 static GdkPixbuf *
 scale_pixbuf (GdkPixbuf *pb)
 {
@@ -282,8 +333,6 @@ parse_desktop_file (gchar * filename)
 
   if (g_key_file_load_from_file (kf, filename, 0, &err))
     {
-      gchar *icon;
-
       if (g_key_file_has_group (kf, "Desktop Entry"))
         {
           gint i, type;
@@ -350,21 +399,8 @@ parse_desktop_file (gchar * filename)
                 }
             }
 
-          /* add icon */
-          icon = g_key_file_get_string (kf, "Desktop Entry", "Icon", NULL);
-          if (icon)
-            {
-              if (options.icons_data.compact)
-                ent->pixbuf = get_pixbuf (icon, YAD_SMALL_ICON, TRUE);
-              else
-                {
-                  GdkPixbuf *pb = get_pixbuf (icon, YAD_BIG_ICON, FALSE);
-                  ent->pixbuf = scale_pixbuf (pb);
-                  if (pb)
-                    g_object_unref (pb);
-                }
-              g_free (icon);
-            }
+          /* icon is loaded later */
+          ent->icon = g_key_file_get_string (kf, "Desktop Entry", "Icon", NULL);
         }
     }
   else
@@ -375,9 +411,489 @@ parse_desktop_file (gchar * filename)
   return ent;
 }
 
+static void
+free_dentry (DEntry *ent)
+{
+  if (!ent)
+    return;
+
+  g_free (ent->name);
+  g_free (ent->comment);
+  g_free (ent->icon);
+  g_free (ent->command);
+  if (ent->pixbuf)
+    g_object_unref (ent->pixbuf);
+  g_free (ent);
+}
+
+static void
+free_scan_job (ScanJob *job)
+{
+  g_free (job->filename);
+  g_free (job->path);
+  if (job->row)
+    gtk_tree_row_reference_free (job->row);
+  free_dentry (job->ent);
+  if (job->pixbuf)
+    g_object_unref (job->pixbuf);
+  g_free (job);
+}
+
+/* decode and scale icon image. may be called from any thread */
+static GdkPixbuf *
+load_icon_file (gchar *file)
+{
+  GdkPixbuf *pb, *spb;
+
+  pb = gdk_pixbuf_new_from_file (file, NULL);
+  if (!pb)
+    return NULL;
+
+  if (!options.icons_data.compact)
+    spb = scale_pixbuf (pb);
+  else if (!options.data.keep_icon_size &&
+           (gdk_pixbuf_get_width (pb) != small_width || gdk_pixbuf_get_height (pb) != small_height))
+    spb = gdk_pixbuf_scale_simple (pb, small_width, small_height, GDK_INTERP_BILINEAR);
+  else
+    spb = g_object_ref (pb);
+  g_object_unref (pb);
+
+  return spb;
+}
+
+/* load icon in main thread, as it was done before */
+static GdkPixbuf *
+load_icon_sync (gchar *icon)
+{
+  GdkPixbuf *pb, *spb;
+
+  if (options.icons_data.compact)
+    return get_pixbuf (icon, YAD_SMALL_ICON, TRUE);
+
+  pb = get_pixbuf (icon, YAD_BIG_ICON, FALSE);
+  spb = scale_pixbuf (pb);
+  if (pb)
+    g_object_unref (pb);
+
+  return spb;
+}
+
+/* set row for desktop file, add it if not exists yet */
+static void
+update_row (const gchar *filename, const gchar *name, const gchar *tooltip,
+            GdkPixbuf *pb, const gchar *cmd, gboolean in_term, GtkTreeIter *iter)
+{
+  GtkTreeRowReference *ref;
+  GtkTreePath *path;
+  gboolean found = FALSE;
+
+  ref = g_hash_table_lookup (dir_rows, filename);
+  if (ref && (path = gtk_tree_row_reference_get_path (ref)) != NULL)
+    {
+      found = gtk_tree_model_get_iter (GTK_TREE_MODEL (store), iter, path);
+      gtk_tree_path_free (path);
+    }
+
+  if (found)
+    {
+      gtk_list_store_set (store, iter,
+                          COL_NAME, name,
+                          COL_TOOLTIP, tooltip,
+                          COL_PIXBUF, pb,
+                          COL_COMMAND, cmd,
+                          COL_TERM, in_term, -1);
+      return;
+    }
+
+  gtk_list_store_insert_with_values (store, iter, -1,
+                                     COL_FILENAME, filename,
+                                     COL_NAME, name,
+                                     COL_TOOLTIP, tooltip,
+                                     COL_PIXBUF, pb,
+                                     COL_COMMAND, cmd,
+                                     COL_TERM, in_term, -1);
+  path = gtk_tree_model_get_path (GTK_TREE_MODEL (store), iter);
+  g_hash_table_replace (dir_rows, g_strdup (filename), gtk_tree_row_reference_new (GTK_TREE_MODEL (store), path));
+  gtk_tree_path_free (path);
+}
+
+static void
+remove_row (const gchar *filename)
+{
+  GtkTreeRowReference *ref;
+  GtkTreePath *path;
+
+  ref = g_hash_table_lookup (dir_rows, filename);
+  if (ref && (path = gtk_tree_row_reference_get_path (ref)) != NULL)
+    {
+      GtkTreeIter iter;
+
+      if (gtk_tree_model_get_iter (GTK_TREE_MODEL (store), &iter, path))
+        gtk_list_store_remove (store, &iter);
+      gtk_tree_path_free (path);
+    }
+  g_hash_table_remove (dir_rows, filename);
+}
+
+static gchar *
+get_cache_name ()
+{
+  GString *key;
+  gchar *dir, *theme = NULL, *sum, *name, *res;
+
+  if (g_path_is_absolute (options.icons_data.directory))
+    dir = g_strdup (options.icons_data.directory);
+  else
+    {
+      gchar *cwd = g_get_current_dir ();
+      dir = g_build_filename (cwd, options.icons_data.directory, NULL);
+      g_free (cwd);
+    }
+
+  if (options.data.icon_theme)
+    theme = g_strdup (options.data.icon_theme);
+  else
+    g_object_get (gtk_settings_get_default (), "gtk-icon-theme-name", &theme, NULL);
+
+  /* everything what affects parsed entries and icons */
+  key = g_string_new (dir);
+  g_string_append_printf (key, "|%d|%d|%d|%d|%d|%dx%d|%d|%s|%s|%s",
+                          options.common_data.icon_size, options.icons_data.compact,
+                          options.icons_data.generic, options.data.keep_icon_size, ICONS_CACHE_VERSION,
+                          small_width, small_height, big_size, g_get_language_names ()[0],
+                          theme ? theme : "", settings.open_cmd);
+
+  sum = g_compute_checksum_for_string (G_CHECKSUM_MD5, key->str, -1);
+  name = g_strdup_printf ("icons-%s.cache", sum);
+  res = g_build_filename (g_get_user_cache_dir (), "yad", name, NULL);
+
+  g_free (name);
+  g_free (sum);
+  g_free (theme);
+  g_free (dir);
+  g_string_free (key, TRUE);
+
+  return res;
+}
+
+static GVariant *
+pixbuf_to_variant (GdkPixbuf *pb)
+{
+  gint w, h, rs;
+  gsize len;
+
+  if (!pb || gdk_pixbuf_get_bits_per_sample (pb) != 8)
+    return g_variant_new ("(biii@ay)", FALSE, 0, 0, 0, g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE, NULL, 0, 1));
+
+  w = gdk_pixbuf_get_width (pb);
+  h = gdk_pixbuf_get_height (pb);
+  rs = gdk_pixbuf_get_rowstride (pb);
+  /* last row may be not padded */
+  len = (gsize) rs * (h - 1) + w * gdk_pixbuf_get_n_channels (pb);
+
+  return g_variant_new ("(biii@ay)", gdk_pixbuf_get_has_alpha (pb), w, h, rs,
+                        g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE, gdk_pixbuf_get_pixels (pb), len, 1));
+}
+
+static GdkPixbuf *
+pixbuf_from_variant (GVariant *v)
+{
+  GVariant *data;
+  GdkPixbuf *pb = NULL;
+  gboolean alpha;
+  gint w, h, rs;
+  gsize len;
+
+  g_variant_get (v, "(biii@ay)", &alpha, &w, &h, &rs, &data);
+  len = (gsize) rs * (h - 1) + w * (alpha ? 4 : 3);
+
+  /* check sizes, cache file may be damaged */
+  if (w > 0 && h > 0 && w < 4096 && h < 4096 && rs < 65536 && rs >= w * (alpha ? 4 : 3) && g_variant_get_size (data) >= len)
+    {
+      guchar *pixels = g_malloc ((gsize) rs * h);
+
+      memcpy (pixels, g_variant_get_data (data), len);
+      pb = gdk_pixbuf_new_from_data (pixels, GDK_COLORSPACE_RGB, alpha, 8, w, h, rs,
+                                     (GdkPixbufDestroyNotify) g_free, NULL);
+    }
+  g_variant_unref (data);
+
+  return pb;
+}
+
+/* returns desktop file name => cache entry */
+static GHashTable *
+load_cache ()
+{
+  GMappedFile *mf;
+  GVariant *root, *entries, *ent;
+  GVariantIter it;
+  GHashTable *res = NULL;
+  guint32 version;
+
+  mf = g_mapped_file_new (cache_file, FALSE, NULL);
+  if (!mf)
+    return NULL;
+
+  /* untrusted data. gvariant takes care about malformed content */
+  root = g_variant_new_from_data (G_VARIANT_TYPE ("(ua" ICONS_CACHE_ENTRY ")"),
+                                  g_mapped_file_get_contents (mf), g_mapped_file_get_length (mf),
+                                  FALSE, (GDestroyNotify) g_mapped_file_unref, mf);
+  g_variant_ref_sink (root);
+
+  g_variant_get (root, "(u@a" ICONS_CACHE_ENTRY ")", &version, &entries);
+  if (version == ICONS_CACHE_VERSION)
+    {
+      res = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_variant_unref);
+      g_variant_iter_init (&it, entries);
+      while ((ent = g_variant_iter_next_value (&it)) != NULL)
+        {
+          gchar *fn;
+
+          g_variant_get_child (ent, 0, "s", &fn);
+          g_hash_table_replace (res, fn, ent);
+        }
+    }
+  g_variant_unref (entries);
+  g_variant_unref (root);
+
+  return res;
+}
+
+static void
+save_cache ()
+{
+  GVariantBuilder b;
+  GVariant *v;
+  GtkTreeIter iter;
+  gboolean valid;
+  gchar *dir;
+
+  cache_dirty = FALSE;
+  if (!cache_file)
+    return;
+
+  g_variant_builder_init (&b, G_VARIANT_TYPE ("a" ICONS_CACHE_ENTRY));
+
+  valid = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter);
+  while (valid)
+    {
+      gchar *fn, *name, *tip, *cmd;
+      gboolean term;
+      GdkPixbuf *pb;
+      FileStat *fs;
+
+      gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, COL_FILENAME, &fn, COL_NAME, &name,
+                          COL_TOOLTIP, &tip, COL_PIXBUF, &pb, COL_COMMAND, &cmd, COL_TERM, &term, -1);
+
+      fs = g_hash_table_lookup (file_stats, fn);
+      if (fs)
+        g_variant_builder_add (&b, "(sxtsssb@(biiiay))", fn, fs->mtime, fs->size,
+                               name ? name : "", tip ? tip : "", cmd ? cmd : "", term, pixbuf_to_variant (pb));
+
+      g_free (fn);
+      g_free (name);
+      g_free (tip);
+      g_free (cmd);
+      if (pb)
+        g_object_unref (pb);
+
+      valid = gtk_tree_model_iter_next (GTK_TREE_MODEL (store), &iter);
+    }
+
+  v = g_variant_ref_sink (g_variant_new ("(u@a" ICONS_CACHE_ENTRY ")", ICONS_CACHE_VERSION,
+                                         g_variant_builder_end (&b)));
+
+  /* cache is optional, so errors are silently ignored */
+  dir = g_path_get_dirname (cache_file);
+  if (g_mkdir_with_parents (dir, 0755) == 0)
+    g_file_set_contents (cache_file, g_variant_get_data (v), g_variant_get_size (v), NULL);
+  g_free (dir);
+
+  g_variant_unref (v);
+}
+
+static FileStat *
+stat_file (const gchar *filename)
+{
+  GStatBuf st;
+  FileStat *fs;
+  gchar *fullname;
+  gint res;
+
+  fullname = g_build_filename (options.icons_data.directory, filename, NULL);
+  res = g_stat (fullname, &st);
+  g_free (fullname);
+
+  if (res != 0)
+    {
+      g_hash_table_remove (file_stats, filename);
+      return NULL;
+    }
+
+  fs = g_new (FileStat, 1);
+  fs->mtime = st.st_mtime;
+  fs->size = st.st_size;
+  g_hash_table_replace (file_stats, g_strdup (filename), fs);
+
+  return fs;
+}
+
+static void
+load_row_icon (GtkTreeIter *iter, gchar *icon)
+{
+  GtkIconInfo *info;
+  const gchar *file = NULL;
+
+  /* icon theme isn't thread safe, so only decoding goes to thread */
+  if (g_file_test (icon, G_FILE_TEST_EXISTS))
+    info = NULL;
+  else
+    {
+      info = gtk_icon_theme_lookup_icon (settings.icon_theme, icon,
+                                         options.icons_data.compact ? MIN (small_width, small_height) : big_size,
+                                         GTK_ICON_LOOKUP_GENERIC_FALLBACK);
+      if (info)
+        file = gtk_icon_info_get_filename (info);
+    }
+
+  if (file)
+    {
+      GtkTreePath *path = gtk_tree_model_get_path (GTK_TREE_MODEL (store), iter);
+      ScanJob *job = g_new0 (ScanJob, 1);
+
+      job->gen = g_atomic_int_get (&scan_gen);
+      job->path = g_strdup (file);
+      job->row = gtk_tree_row_reference_new (GTK_TREE_MODEL (store), path);
+      gtk_tree_path_free (path);
+      scan_pending++;
+      g_thread_pool_push (scan_pool, job, NULL);
+    }
+  else
+    {
+      GdkPixbuf *pb = load_icon_sync (icon);
+      gtk_list_store_set (store, iter, COL_PIXBUF, pb, -1);
+      if (pb)
+        g_object_unref (pb);
+    }
+
+  if (info)
+#if !GTK_CHECK_VERSION(3,0,0)
+    gtk_icon_info_free (info);
+#else
+    g_object_unref (info);
+#endif
+}
+
+static gboolean
+scan_results_cb (gpointer data)
+{
+  GPtrArray *jobs;
+  guint i;
+
+  G_LOCK (scan_lock);
+  jobs = scan_results;
+  scan_results = g_ptr_array_new ();
+  scan_idle = 0;
+  G_UNLOCK (scan_lock);
+
+  for (i = 0; i < jobs->len; i++)
+    {
+      ScanJob *job = g_ptr_array_index (jobs, i);
+      GtkTreeIter iter;
+
+      scan_pending--;
+      if (job->gen != g_atomic_int_get (&scan_gen))
+        {
+          free_scan_job (job);
+          continue;
+        }
+      cache_dirty = TRUE;
+
+      if (job->row)
+        {
+          /* icon decoded */
+          GtkTreePath *path = gtk_tree_row_reference_get_path (job->row);
+
+          if (path)
+            {
+              gtk_tree_model_get_iter (GTK_TREE_MODEL (store), &iter, path);
+              /* get fallback image if decoding failed */
+              if (!job->pixbuf)
+                job->pixbuf = load_icon_sync (job->path);
+              gtk_list_store_set (store, &iter, COL_PIXBUF, job->pixbuf, -1);
+              gtk_tree_path_free (path);
+            }
+        }
+      else
+        {
+          DEntry *ent = job->ent;
+
+          if (!ent->name)
+            remove_row (job->filename);
+          else
+            {
+              update_row (job->filename, ent->name, ent->comment ? ent->comment : "",
+                          ent->pixbuf, ent->command ? ent->command : "", ent->in_term, &iter);
+              if (ent->icon && !ent->pixbuf)
+                load_row_icon (&iter, ent->icon);
+            }
+        }
+
+      free_scan_job (job);
+    }
+  g_ptr_array_free (jobs, TRUE);
+
+  /* all done, remember results for next time */
+  if (scan_pending == 0 && cache_dirty)
+    save_cache ();
+
+  return FALSE;
+}
+
+static void
+scan_job_func (gpointer data, gpointer user_data)
+{
+  ScanJob *job = (ScanJob *) data;
+
+  /* outdated jobs are just passed back to main thread for freeing */
+  if (job->gen == g_atomic_int_get (&scan_gen))
+    {
+      if (job->row)
+        job->pixbuf = load_icon_file (job->path);
+      else
+        {
+          job->ent = parse_desktop_file (job->path);
+          /* decode icons given as file names right here */
+          if (job->ent->icon && g_file_test (job->ent->icon, G_FILE_TEST_EXISTS))
+            job->ent->pixbuf = load_icon_file (job->ent->icon);
+        }
+    }
+
+  G_LOCK (scan_lock);
+  g_ptr_array_add (scan_results, job);
+  if (!scan_idle)
+    scan_idle = g_idle_add (scan_results_cb, NULL);
+  G_UNLOCK (scan_lock);
+}
+
+static void
+push_scan_job (const gchar *filename)
+{
+  ScanJob *job;
+
+  job = g_new0 (ScanJob, 1);
+  job->gen = g_atomic_int_get (&scan_gen);
+  job->filename = g_strdup (filename);
+  job->path = g_build_filename (options.icons_data.directory, filename, NULL);
+  scan_pending++;
+  g_thread_pool_push (scan_pool, job, NULL);
+}
+
 static void
 read_dir ()
 {
+  GHashTable *cache;
   GDir *dir;
   const gchar *filename;
   GError *err = NULL;
@@ -389,50 +905,141 @@ read_dir ()
       return;
     }
 
+  if (!scan_pool)
+    {
+      scan_results = g_ptr_array_new ();
+      dir_rows = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                        (GDestroyNotify) gtk_tree_row_reference_free);
+      file_stats = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+      cache_file = get_cache_name ();
+      scan_pool = g_thread_pool_new (scan_job_func, NULL, g_get_num_processors (), FALSE, NULL);
+    }
+
+  /* results of previous scan will be dropped */
+  g_atomic_int_inc (&scan_gen);
+  g_hash_table_remove_all (dir_rows);
+  g_hash_table_remove_all (file_stats);
   gtk_list_store_clear (store);
 
+  cache = load_cache ();
+  cache_dirty = (cache == NULL);
+
   while ((filename = g_dir_read_name (dir)) != NULL)
     {
-      DEntry *ent;
-      GtkTreeIter iter;
-      gchar *fullname;
+      FileStat *fs;
+      GVariant *ent;
 
       if (!g_str_has_suffix (filename, ".desktop"))
         continue;
 
-      fullname = g_build_filename (options.icons_data.directory, filename, NULL);
-      ent = parse_desktop_file (fullname);
-      g_free (fullname);
+      fs = stat_file (filename);
+      if (!fs)
+        continue;
 
-      if (ent->name)
+      /* take unchanged entries from cache */
+      ent = cache ? g_hash_table_lookup (cache, filename) : NULL;
+      if (ent)
         {
-          gtk_list_store_append (store, &iter);
-          gtk_list_store_set (store, &iter,
-                              COL_FILENAME, filename,
-                              COL_NAME, ent->name,
-                              COL_TOOLTIP, ent->comment ? ent->comment : "",
-                              COL_PIXBUF, ent->pixbuf,
-                              COL_COMMAND, ent->command ? ent->command : "", COL_TERM, ent->in_term, -1);
+          gint64 mtime;
+          guint64 size;
+          const gchar *name, *tip, *cmd;
+          gboolean term, hit = FALSE;
+          GVariant *pv;
+
+          g_variant_get (ent, "(&sxt&s&s&sb@(biiiay))", NULL, &mtime, &size, &name, &tip, &cmd, &term, &pv);
+          if (mtime == fs->mtime && size == fs->size)
+            {
+              GtkTreeIter iter;
+              GdkPixbuf *pb = pixbuf_from_variant (pv);
+
+              update_row (filename, name, tip, pb, cmd, term, &iter);
+              if (pb)
+                g_object_unref (pb);
+              hit = TRUE;
+            }
+          g_variant_unref (pv);
+          g_hash_table_remove (cache, filename);
+
+          if (hit)
+            continue;
         }
 
-      /* free desktop entry */
-      g_free (ent->name);
-      g_free (ent->comment);
-      g_free (ent->command);
-      if (ent->pixbuf)
-        g_object_unref (ent->pixbuf);
-      g_free (ent);
+      push_scan_job (filename);
+      cache_dirty = TRUE;
     }
 
+  /* entries for removed files left in cache */
+  if (cache)
+    {
+      if (g_hash_table_size (cache) > 0)
+        cache_dirty = TRUE;
+      g_hash_table_destroy (cache);
+    }
+
+  if (scan_pending == 0 && cache_dirty)
+    save_cache ();
+
   g_dir_close (dir);
 }
 
 #ifdef HAVE_GIO
+static gboolean
+apply_dir_changes (gpointer data)
+{
+  GHashTableIter it;
+  gchar *name;
+
+  g_hash_table_iter_init (&it, changed_files);
+  while (g_hash_table_iter_next (&it, (gpointer *) &name, NULL))
+    {
+      gchar *fullname = g_build_filename (options.icons_data.directory, name, NULL);
+
+      if (g_file_test (fullname, G_FILE_TEST_IS_REGULAR) && stat_file (name))
+        push_scan_job (name);
+      else
+        {
+          /* file was removed */
+          remove_row (name);
+          cache_dirty = TRUE;
+        }
+      g_free (fullname);
+    }
+  g_hash_table_remove_all (changed_files);
+
+  if (scan_pending == 0 && cache_dirty)
+    save_cache ();
+
+  changed_timeout = 0;
+  return FALSE;
+}
+
 static void
 dir_changed_cb (GFileMonitor *mon, GFile *file, GFile *ofile, GFileMonitorEvent ev, gpointer data)
 {
-  if (ev == G_FILE_MONITOR_EVENT_DELETED || ev == G_FILE_MONITOR_EVENT_CREATED)
-    read_dir ();
+  gchar *name;
+
+  switch (ev)
+    {
+    case G_FILE_MONITOR_EVENT_CREATED:
+    case G_FILE_MONITOR_EVENT_DELETED:
+    case G_FILE_MONITOR_EVENT_CHANGED:
+    case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+      break;
+    default:
+      return;
+    }
+
+  name = g_file_get_basename (file);
+  if (!g_str_has_suffix (name, ".desktop"))
+    {
+      g_free (name);
+      return;
+    }
+
+  /* collect changes and apply them at once */
+  g_hash_table_add (changed_files, name);
+  if (!changed_timeout)
+    changed_timeout = g_timeout_add (MONITOR_DELAY, apply_dir_changes, NULL);
 }
 #endif
 
@@ -440,11 +1047,16 @@ GtkWidget *
 icons_create_widget (GtkWidget * dlg)
 {
   GtkWidget *w;
+  gint iw, ih;
 
   w = gtk_scrolled_window_new (NULL, NULL);
   gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (w), GTK_SHADOW_ETCHED_IN);
   gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (w), options.hscroll_policy, options.vscroll_policy);
 
+  gtk_icon_size_lookup (GTK_ICON_SIZE_MENU, &small_width, &small_height);
+  gtk_icon_size_lookup (GTK_ICON_SIZE_DIALOG, &iw, &ih);
+  big_size = MIN (iw, ih);
+
   store = gtk_list_store_new (NUM_COLS, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING,
                               GDK_TYPE_PIXBUF, G_TYPE_STRING, G_TYPE_BOOLEAN);
   gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store),
@@ -523,6 +1135,7 @@ icons_create_widget (GtkWidget * dlg)
       if (file)
         {
           GFileMonitor *mon = g_file_monitor_directory (file, 0, NULL, NULL);
+          changed_files = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
           g_signal_connect (G_OBJECT (mon), "changed", G_CALLBACK (dir_changed_cb), NULL);
           g_object_unref (file);
         }
@@ -988,6 +988,8 @@ main (gint argc, gchar ** argv)
                 yad_print_result ();
             }
         }
+      if (options.mode == YAD_MODE_PROGRESS && options.progress_data.eta)
+        progress_print_stats ();
 #ifndef G_OS_WIN32
       if (options.mode == YAD_MODE_NOTEBOOK)
         notebook_close_childs ();
@@ -42,6 +42,7 @@ static gboolean set_expander (const gchar *, const gchar *, gpointer, GError **)
 static gboolean set_orient (const gchar *, const gchar *, gpointer, GError **);
 static gboolean set_print_type (const gchar *, const gchar *, gpointer, GError **);
 static gboolean set_progress_log (const gchar *, const gchar *, gpointer, GError **);
+static gboolean set_progress_pipe (const gchar *, const gchar *, gpointer, GError **);
 static gboolean set_size (const gchar *, const gchar *, gpointer, GError **);
 static gboolean set_posx (const gchar *, const gchar *, gpointer, GError **);
 static gboolean set_posy (const gchar *, const gchar *, gpointer, GError **);
@@ -51,6 +52,7 @@ static gboolean parse_signal (const gchar *, const gchar *, gpointer, GError **)
 #endif
 static gboolean add_image_path (const gchar *, const gchar *, gpointer, GError **);
 static gboolean set_complete_type (const gchar *, const gchar *, gpointer, GError **);
+static gboolean set_search_type (const gchar *, const gchar *, gpointer, GError **);
 static gboolean set_bool_fmt_type (const gchar *, const gchar *, gpointer, GError **);
 static gboolean set_grid_lines (const gchar *, const gchar *, gpointer, GError **);
 static gboolean set_scroll_policy (const gchar *, const gchar *, gpointer, GError **);
@@ -293,6 +295,10 @@ static GOptionEntry entry_options[] = {
     N_("Hide the entry text"), NULL },
   { "completion", 0, 0, G_OPTION_ARG_NONE, &options.entry_data.completion,
     N_("Use completion instead of combo-box"), NULL },
+  { "completion-file", 0, 0, G_OPTION_ARG_FILENAME, &options.entry_data.completion_file,
+    N_("Read completion values from file (- for stdin)"), N_("FILENAME") },
+  { "completion-cmd", 0, 0, G_OPTION_ARG_STRING, &options.entry_data.completion_cmd,
+    N_("Read completion values from command output"), N_("CMD") },
   { "numeric", 0, 0, G_OPTION_ARG_NONE, &options.entry_data.numeric,
     N_("Use spin button for text entry"), NULL },
   { "licon", 0, 0, G_OPTION_ARG_FILENAME, &options.entry_data.licon,
@@ -337,7 +343,7 @@ static GOptionEntry form_options[] = {
     N_("Set alignment of filed labels (left, center or right)"), N_("TYPE") },
   { "columns", 0, 0, G_OPTION_ARG_INT, &options.form_data.columns,
     N_("Set number of columns in form"), N_("NUMBER") },
-  { "scroll", 0, 0, G_OPTION_ARG_NONE, &options.form_data.scroll,
+  { "scroll", 0, G_OPTION_FLAG_NOALIAS, G_OPTION_ARG_NONE, &options.common_data.scroll,
     N_("Make form scrollable"), NULL },
   { "homogeneous", 0, 0, G_OPTION_ARG_NONE, &options.form_data.homogeneous,
     N_("Make form fields same height"), NULL },
@@ -347,6 +353,8 @@ static GOptionEntry form_options[] = {
     N_("Set focused field"), N_("NUMBER") },
   { "cycle-read", 0, 0, G_OPTION_ARG_NONE, &options.form_data.cycle_read,
     N_("Cycled reading of stdin data"), NULL },
+  { "keyed-input", 0, 0, G_OPTION_ARG_NONE, &options.form_data.keyed_input,
+    N_("Read fields values from stdin as NUMBER:VALUE or @ATID:VALUE"), NULL },
   { "align-buttons", 0, 0, G_OPTION_ARG_NONE, &options.form_data.align_buttons,
     N_("Align labels on button fields"), NULL },
   { "changed-action", 0, 0, G_OPTION_ARG_STRING, &options.form_data.changed_action,
@@ -554,6 +562,16 @@ static GOptionEntry progress_options[] = {
     N_("Set progress text (not with --bar)"), N_("TEXT") },
   { "hide-text", 0, G_OPTION_FLAG_NOALIAS, G_OPTION_ARG_NONE, &options.common_data.hide_text,
     N_("Hide text on progress bar"), NULL },
+  { "scroll", 0, G_OPTION_FLAG_NOALIAS, G_OPTION_ARG_NONE, &options.common_data.scroll,
+    N_("Make bars area scrollable"), NULL },
+  { "eta", 0, 0, G_OPTION_ARG_NONE, &options.progress_data.eta,
+    N_("Show rate and estimated time in bars"), NULL },
+  { "pipe", 0, G_OPTION_FLAG_OPTIONAL_ARG, G_OPTION_ARG_CALLBACK, set_progress_pipe,
+    N_("Copy stdin to stdout and show amount of passed data"), N_("[SIZE]") },
+  { "socket", 0, 0, G_OPTION_ARG_FILENAME, &options.progress_data.socket,
+    N_("Read progress data from UNIX socket"), N_("PATH") },
+  { "fifo", 0, 0, G_OPTION_ARG_FILENAME, &options.progress_data.fifo,
+    N_("Read progress data from named pipe"), N_("PATH") },
   { "percentage", 0, 0, G_OPTION_ARG_INT, &options.progress_data.percentage,
     N_("Set initial percentage"), N_("PERCENTAGE") },
   { "pulsate", 0, 0, G_OPTION_ARG_NONE, &options.progress_data.pulsate,
@@ -575,6 +593,8 @@ static GOptionEntry progress_options[] = {
     N_("Place log window above progress bar"), NULL },
   { "log-height", 0, 0, G_OPTION_ARG_INT, &options.progress_data.log_height,
     N_("Height of log window"), NULL },
+  { "log-lines", 0, 0, G_OPTION_ARG_INT, &options.progress_data.log_lines,
+    N_("Maximum number of lines in log window"), N_("NUMBER") },
   { "multi-progress", 0, G_OPTION_FLAG_NOALIAS, G_OPTION_ARG_NONE, &progress_mode,
     N_("Alias for --progress"), NULL },
   { NULL }
@@ -627,6 +647,16 @@ static GOptionEntry text_options[] = {
     N_("Make URI clickable"), NULL },
   { "uri-color", 0, 0, G_OPTION_ARG_STRING, &options.text_data.uri_color,
     N_("Use specified color for links"), N_("COLOR") },
+  { "search-type", 0, 0, G_OPTION_ARG_CALLBACK, set_search_type,
+    N_("Set search type (regex, literal or caseless)"), N_("TYPE") },
+  { "ansi", 0, 0, G_OPTION_ARG_NONE, &options.text_data.ansi,
+    N_("Interpret ANSI color escape sequences"), NULL },
+  { "input-encoding", 0, 0, G_OPTION_ARG_STRING, &options.text_data.encoding,
+    N_("Set encoding of input data (auto for detection)"), N_("ENCODING") },
+#ifdef HAVE_GIO
+  { "follow", 0, 0, G_OPTION_ARG_NONE, &options.text_data.follow,
+    N_("Show data appended to the file"), NULL },
+#endif
   { NULL }
 };
 
@@ -1168,6 +1198,48 @@ set_progress_log (const gchar * option_name, const gchar * value, gpointer data,
   return TRUE;
 }
 
+static gboolean
+set_progress_pipe (const gchar * option_name, const gchar * value, gpointer data, GError ** err)
+{
+  options.progress_data.pipe = TRUE;
+
+  if (value)
+    {
+      gchar *end;
+      guint64 size = g_ascii_strtoull (value, &end, 10);
+      guint shift = 0;
+
+      switch (g_ascii_toupper (*end))
+        {
+        case 'T':
+          shift += 10;
+          /* fall through */
+        case 'G':
+          shift += 10;
+          /* fall through */
+        case 'M':
+          shift += 10;
+          /* fall through */
+        case 'K':
+          shift += 10;
+          /* fall through */
+        case '\0':
+          break;
+        default:
+          g_printerr (_("Unknown size suffix: %s\n"), value);
+        }
+
+      if (size > (G_MAXUINT64 >> shift))
+        {
+          g_printerr (_("Size is too large: %s\n"), value);
+          size = 0;
+        }
+      options.progress_data.pipe_size = size << shift;
+    }
+
+  return TRUE;
+}
+
 static gboolean
 set_size (const gchar * option_name, const gchar * value, gpointer data, GError ** err)
 {
@@ -1223,6 +1295,21 @@ set_complete_type (const gchar * option_name, const gchar * value, gpointer data
   return TRUE;
 }
 
+static gboolean
+set_search_type (const gchar * option_name, const gchar * value, gpointer data, GError ** err)
+{
+  if (strcasecmp (value, "regex") == 0)
+    options.text_data.search_type = YAD_SEARCH_REGEX;
+  else if (strcasecmp (value, "literal") == 0)
+    options.text_data.search_type = YAD_SEARCH_LITERAL;
+  else if (strcasecmp (value, "caseless") == 0)
+    options.text_data.search_type = YAD_SEARCH_CASELESS;
+  else
+    g_printerr (_("Unknown search type: %s\n"), value);
+
+  return TRUE;
+}
+
 static gboolean
 set_bool_fmt_type (const gchar * option_name, const gchar * value, gpointer data, GError ** err)
 {
@@ -1575,6 +1662,7 @@ yad_options_init (void)
   options.common_data.quoted_output = FALSE;
   options.common_data.num_output = FALSE;
   options.common_data.hide_text = FALSE;
+  options.common_data.scroll = FALSE;
   options.common_data.filters = NULL;
   options.common_data.key = -1;
   options.common_data.bool_fmt = YAD_BOOL_FMT_UT;
@@ -1613,6 +1701,8 @@ yad_options_init (void)
   options.entry_data.entry_text = NULL;
   options.entry_data.entry_label = NULL;
   options.entry_data.completion = FALSE;
+  options.entry_data.completion_file = NULL;
+  options.entry_data.completion_cmd = NULL;
   options.entry_data.numeric = FALSE;
   options.entry_data.licon = NULL;
   options.entry_data.licon_action = NULL;
@@ -1635,10 +1725,10 @@ yad_options_init (void)
   /* Initialize form data */
   options.form_data.fields = NULL;
   options.form_data.columns = 1;
-  options.form_data.scroll = FALSE;
   options.form_data.output_by_row = FALSE;
   options.form_data.focus_field = 1;
   options.form_data.cycle_read = FALSE;
+  options.form_data.keyed_input = FALSE;
   options.form_data.align_buttons = FALSE;
   options.form_data.changed_action = NULL;
   options.form_data.homogeneous = FALSE;
@@ -1744,6 +1834,12 @@ yad_options_init (void)
   options.progress_data.log_expanded = FALSE;
   options.progress_data.log_on_top = FALSE;
   options.progress_data.log_height = -1;
+  options.progress_data.log_lines = 0;
+  options.progress_data.eta = FALSE;
+  options.progress_data.pipe = FALSE;
+  options.progress_data.pipe_size = 0;
+  options.progress_data.socket = NULL;
+  options.progress_data.fifo = NULL;
 
   /* Initialize scale data */
   options.scale_data.value = 0;
@@ -1767,6 +1863,12 @@ yad_options_init (void)
   options.text_data.margins = 0;
   options.text_data.hide_cursor = TRUE;
   options.text_data.uri_color = "blue";
+  options.text_data.search_type = YAD_SEARCH_REGEX;
+  options.text_data.ansi = FALSE;
+  options.text_data.encoding = NULL;
+#ifdef HAVE_GIO
+  options.text_data.follow = FALSE;
+#endif
 
 #ifdef HAVE_SOURCEVIEW
   /* Initialize sourceview data */
@@ -19,7 +19,14 @@
 
 #include "yad.h"
 
+/* big images are drawn by tiles from a pyramid of downscaled copies */
+#define PICTURE_TILE_SIZE 256
+#define PICTURE_MIN_LEVEL 256
+#define PICTURE_TILE_CACHE 64           /* minimal size of tile cache */
+#define PICTURE_READ_CHUNK 65536
+
 static GtkWidget *picture;
+static GtkWidget *picture_box;
 static GtkWidget *viewport;
 static GtkWidget *popup_menu;
 
@@ -29,6 +36,34 @@ static GdkPixbuf *orig_pb;
 static gboolean loaded = FALSE;
 static gboolean animated = FALSE;
 
+/* progressive loading */
+static gchar *picture_file = NULL;
+static GdkPixbufLoader *loader = NULL;
+static FILE *loader_input = NULL;
+static gint image_width, image_height;  /* size of image in file */
+static gboolean reduced = FALSE;        /* image was decoded at lower size */
+static gboolean reloading = FALSE;
+static gboolean fit_pending = FALSE;
+static cairo_region_t *decoded = NULL;  /* decoded part of partial image */
+
+/* current view. scale is relative to original image */
+static gdouble scale = 1.0;
+static cairo_matrix_t orient;
+static gint orient_width, orient_height;
+
+/* mip levels. level 0 is original image, each next is twice smaller */
+static GPtrArray *levels = NULL;
+G_LOCK_DEFINE_STATIC (levels_lock);
+
+typedef struct {
+  gint64 key;
+  cairo_surface_t *surface;
+} PictureTile;
+
+static GHashTable *tiles = NULL;
+static GQueue *tiles_lru = NULL;
+static guint tiles_max = PICTURE_TILE_CACHE;
+
 enum {
   SIZE_FIT,
   SIZE_ORIG,
@@ -43,133 +78,569 @@ enum {
   ROTATE_FLIP_HOR
 };
 
+static gboolean
+level_ready_cb (gpointer data)
+{
+  gtk_widget_queue_draw (picture);
+  return FALSE;
+}
+
+static gpointer
+build_levels_thread (gpointer data)
+{
+  GPtrArray *lv = (GPtrArray *) data;
+  GdkPixbuf *pb = g_ptr_array_index (lv, 0);
+
+  while (MAX (gdk_pixbuf_get_width (pb), gdk_pixbuf_get_height (pb)) > PICTURE_MIN_LEVEL)
+    {
+      gint w = MAX (1, gdk_pixbuf_get_width (pb) / 2);
+      gint h = MAX (1, gdk_pixbuf_get_height (pb) / 2);
+
+      /* each level is made from previous one, so it's cheap */
+      pb = gdk_pixbuf_scale_simple (pb, w, h, GDK_INTERP_BILINEAR);
+      if (!pb)
+        break;
+
+      G_LOCK (levels_lock);
+      g_ptr_array_add (lv, pb);
+      G_UNLOCK (levels_lock);
+
+      g_idle_add (level_ready_cb, NULL);
+    }
+  g_ptr_array_unref (lv);
+
+  return NULL;
+}
+
+/* take the smallest level which is still not less than needed */
+static gint
+get_level (GdkPixbuf **pb)
+{
+  gint lvl = 0;
+
+  G_LOCK (levels_lock);
+  while (lvl + 1 < levels->len &&
+         (gdouble) gdk_pixbuf_get_width (g_ptr_array_index (levels, lvl + 1)) >= image_width * scale)
+    lvl++;
+  *pb = g_object_ref (g_ptr_array_index (levels, lvl));
+  G_UNLOCK (levels_lock);
+
+  return lvl;
+}
+
+static cairo_surface_t *
+get_tile (GdkPixbuf *pb, gint lvl, gint tx, gint ty)
+{
+  PictureTile *t;
+  GList *link;
+  gint64 key;
+
+  key = ((gint64) lvl << 48) | ((gint64) ty << 24) | tx;
+
+  link = g_hash_table_lookup (tiles, &key);
+  if (link)
+    {
+      g_queue_unlink (tiles_lru, link);
+      g_queue_push_head_link (tiles_lru, link);
+      t = (PictureTile *) link->data;
+    }
+  else
+    {
+      GdkPixbuf *sub;
+      cairo_t *cr;
+      gint x, y, w, h;
+
+      x = tx * PICTURE_TILE_SIZE;
+      y = ty * PICTURE_TILE_SIZE;
+      w = MIN (PICTURE_TILE_SIZE, gdk_pixbuf_get_width (pb) - x);
+      h = MIN (PICTURE_TILE_SIZE, gdk_pixbuf_get_height (pb) - y);
+
+      t = g_new0 (PictureTile, 1);
+      t->key = key;
+      t->surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, w, h);
+
+      sub = gdk_pixbuf_new_subpixbuf (pb, x, y, w, h);
+      cr = cairo_create (t->surface);
+      gdk_cairo_set_source_pixbuf (cr, sub, 0, 0);
+      cairo_paint (cr);
+      cairo_destroy (cr);
+      g_object_unref (sub);
+
+      g_queue_push_head (tiles_lru, t);
+      g_hash_table_insert (tiles, &t->key, tiles_lru->head);
+
+      while (g_queue_get_length (tiles_lru) > tiles_max)
+        {
+          PictureTile *old = g_queue_pop_tail (tiles_lru);
+          g_hash_table_remove (tiles, &old->key);
+          cairo_surface_destroy (old->surface);
+          g_free (old);
+        }
+    }
+
+  return t->surface;
+}
+
 static void
-load_picture (gchar *filename)
+draw_picture (GtkWidget *w, cairo_t *cr)
 {
-  anim_pb = gdk_pixbuf_animation_new_from_file (filename, NULL);
-  orig_pb = gdk_pixbuf_animation_get_static_image (anim_pb);
+  GdkPixbuf *pb;
+  GtkAllocation alloc;
+  gdouble x1, y1, x2, y2, dw, dh, ts;
+  gint lvl, tx, ty, tx1, ty1, tx2, ty2;
 
-  if (orig_pb)
+  if (!orig_pb)
+    return;
+
+  lvl = get_level (&pb);
+
+  /* keep at least two screens of tiles, otherwise scrolling converts all of them again */
+  gtk_widget_get_allocation (viewport, &alloc);
+  ts = PICTURE_TILE_SIZE * scale * image_width / gdk_pixbuf_get_width (pb);
+  tiles_max = MIN (((gint) (alloc.width / ts) + 2) * ((gint) (alloc.height / ts) + 2),
+                   ((gdk_pixbuf_get_width (pb) - 1) / PICTURE_TILE_SIZE + 1) *
+                   ((gdk_pixbuf_get_height (pb) - 1) / PICTURE_TILE_SIZE + 1));
+  tiles_max = MAX (PICTURE_TILE_CACHE, 2 * tiles_max);
+
+  /* center image in widget */
+  gtk_widget_get_allocation (w, &alloc);
+  dw = orient_width * scale;
+  dh = orient_height * scale;
+  cairo_translate (cr, MAX (0, (alloc.width - dw) / 2), MAX (0, (alloc.height - dh) / 2));
+
+  /* level pixels => original pixels => rotated => scaled */
+  cairo_scale (cr, scale, scale);
+  cairo_transform (cr, &orient);
+  cairo_scale (cr, (gdouble) image_width / gdk_pixbuf_get_width (pb),
+               (gdouble) image_height / gdk_pixbuf_get_height (pb));
+
+  /* while loading show only decoded part of level 0 */
+  if (decoded && lvl == 0)
     {
-      if (gdk_pixbuf_animation_is_static_image (anim_pb))
-        gtk_image_set_from_pixbuf (GTK_IMAGE (picture), orig_pb);
-      else
+      gint i;
+
+      for (i = 0; i < cairo_region_num_rectangles (decoded); i++)
         {
-          gtk_image_set_from_animation (GTK_IMAGE (picture), anim_pb);
-          animated = TRUE;
+          cairo_rectangle_int_t r;
+
+          cairo_region_get_rectangle (decoded, i, &r);
+          cairo_rectangle (cr, r.x, r.y, r.width, r.height);
         }
-      loaded = TRUE;
+      cairo_clip (cr);
     }
-  else
-    gtk_image_set_from_icon_name (GTK_IMAGE (picture), "image-missing", GTK_ICON_SIZE_DIALOG);
+
+  /* visible area in level coordinates */
+  cairo_clip_extents (cr, &x1, &y1, &x2, &y2);
+  tx1 = MAX (0, (gint) (x1 / PICTURE_TILE_SIZE));
+  ty1 = MAX (0, (gint) (y1 / PICTURE_TILE_SIZE));
+  tx2 = MIN ((gdk_pixbuf_get_width (pb) - 1) / PICTURE_TILE_SIZE, (gint) (x2 / PICTURE_TILE_SIZE));
+  ty2 = MIN ((gdk_pixbuf_get_height (pb) - 1) / PICTURE_TILE_SIZE, (gint) (y2 / PICTURE_TILE_SIZE));
+
+  for (ty = ty1; ty <= ty2; ty++)
+    {
+      for (tx = tx1; tx <= tx2; tx++)
+        {
+          cairo_surface_t *s = get_tile (pb, lvl, tx, ty);
+
+          cairo_set_source_surface (cr, s, tx * PICTURE_TILE_SIZE, ty * PICTURE_TILE_SIZE);
+          /* avoid seams between tiles */
+          cairo_pattern_set_extend (cairo_get_source (cr), CAIRO_EXTEND_PAD);
+          cairo_pattern_set_filter (cairo_get_source (cr), CAIRO_FILTER_GOOD);
+          cairo_rectangle (cr, tx * PICTURE_TILE_SIZE, ty * PICTURE_TILE_SIZE,
+                           cairo_image_surface_get_width (s), cairo_image_surface_get_height (s));
+          cairo_fill (cr);
+        }
+    }
+
+  g_object_unref (pb);
 }
 
-void
-picture_fit_to_window ()
+#if !GTK_CHECK_VERSION(3,0,0)
+static gboolean
+expose_cb (GtkWidget *w, GdkEventExpose *ev, gpointer data)
+{
+  cairo_t *cr = gdk_cairo_create (gtk_widget_get_window (w));
+
+  gdk_cairo_region (cr, ev->region);
+  cairo_clip (cr);
+  draw_picture (w, cr);
+  cairo_destroy (cr);
+
+  return TRUE;
+}
+#else
+static gboolean
+draw_cb (GtkWidget *w, cairo_t *cr, gpointer data)
+{
+  draw_picture (w, cr);
+  return TRUE;
+}
+#endif
+
+static void
+update_picture_size ()
+{
+  gtk_widget_set_size_request (picture, MAX (1, orient_width * scale), MAX (1, orient_height * scale));
+  gtk_widget_queue_draw (picture);
+}
+
+static void
+clear_tiles ()
+{
+  PictureTile *t;
+
+  g_hash_table_remove_all (tiles);
+  while ((t = g_queue_pop_head (tiles_lru)) != NULL)
+    {
+      cairo_surface_destroy (t->surface);
+      g_free (t);
+    }
+}
+
+/* forget level 0 tiles in updated area */
+static void
+drop_tiles (gint x, gint y, gint w, gint h)
 {
-  gdouble width, height, ww, wh;
+  gint tx, ty;
+
+  for (ty = y / PICTURE_TILE_SIZE; ty <= (y + h - 1) / PICTURE_TILE_SIZE; ty++)
+    {
+      for (tx = x / PICTURE_TILE_SIZE; tx <= (x + w - 1) / PICTURE_TILE_SIZE; tx++)
+        {
+          gint64 key = ((gint64) ty << 24) | tx;
+          GList *link = g_hash_table_lookup (tiles, &key);
+
+          if (link)
+            {
+              PictureTile *t = (PictureTile *) link->data;
+
+              g_hash_table_remove (tiles, &key);
+              g_queue_delete_link (tiles_lru, link);
+              cairo_surface_destroy (t->surface);
+              g_free (t);
+            }
+        }
+    }
+}
+
+/* use new image as level 0 */
+static void
+set_image (GdkPixbuf *pb)
+{
+  GPtrArray *old;
+
+  if (orig_pb)
+    g_object_unref (orig_pb);
+  orig_pb = g_object_ref (pb);
+
+  G_LOCK (levels_lock);
+  old = levels;
+  levels = g_ptr_array_new_with_free_func (g_object_unref);
+  g_ptr_array_add (levels, g_object_ref (pb));
+  G_UNLOCK (levels_lock);
+
+  if (old)
+    g_ptr_array_unref (old);
+  clear_tiles ();
+}
+
+static void
+picture_failed ()
+{
+  gtk_widget_destroy (picture);
+  picture = gtk_image_new_from_icon_name ("image-missing", GTK_ICON_SIZE_DIALOG);
+  gtk_container_add (GTK_CONTAINER (picture_box), picture);
+  gtk_widget_show (picture);
+}
+
+static void
+size_prepared_cb (GdkPixbufLoader *l, gint w, gint h, gpointer data)
+{
+  gint sw, sh;
   gdouble factor;
 
-  if (animated)
-    return;
+  image_width = w;
+  image_height = h;
 
-  width = gdk_pixbuf_get_width (orig_pb);
-  height = gdk_pixbuf_get_height (orig_pb);
+  if (reloading || options.picture_data.size != YAD_PICTURE_FIT)
+    return;
 
-  ww = gdk_window_get_width (gtk_viewport_get_view_window (GTK_VIEWPORT (viewport)));
-  wh = gdk_window_get_height (gtk_viewport_get_view_window (GTK_VIEWPORT (viewport)));
+  /* window can't be bigger than screen, so full size isn't needed for fitting */
+  if (options.data.width > 0 && options.data.height > 0)
+    {
+      sw = options.data.width;
+      sh = options.data.height;
+    }
+  else
+    {
+      SETUNDEPR (sw, gdk_screen_get_width, gdk_screen_get_default ());
+      SETUNDEPR (sh, gdk_screen_get_height, gdk_screen_get_default ());
+    }
 
-  factor = MIN (ww / width, wh / height);
+  factor = MIN ((gdouble) sw / w, (gdouble) sh / h);
   if (factor < 1.0)
     {
-      GdkPixbuf *pb = gdk_pixbuf_scale_simple (g_object_ref (orig_pb), width * factor, height * factor, GDK_INTERP_HYPER);
-      if (pb)
+      gdk_pixbuf_loader_set_size (l, MAX (1, w * factor), MAX (1, h * factor));
+      scale = factor;
+      reduced = TRUE;
+    }
+}
+
+static void
+area_prepared_cb (GdkPixbufLoader *l, gpointer data)
+{
+  GdkPixbuf *pb = gdk_pixbuf_loader_get_pixbuf (l);
+
+  /* show partial image while loading. pixbuf belongs to loader and may be
+   * already complete, so not decoded part is hidden by clipping */
+  if (decoded)
+    cairo_region_destroy (decoded);
+  decoded = cairo_region_create ();
+  set_image (pb);
+
+  orient_width = image_width;
+  orient_height = image_height;
+  cairo_matrix_init_identity (&orient);
+  loaded = TRUE;
+
+  update_picture_size ();
+  if (fit_pending)
+    picture_fit_to_window ();
+}
+
+static void
+area_updated_cb (GdkPixbufLoader *l, gint x, gint y, gint w, gint h, gpointer data)
+{
+  cairo_rectangle_int_t r;
+
+  if (w <= 0 || h <= 0)
+    return;
+
+  if (decoded)
+    {
+      r.x = x;
+      r.y = y;
+      r.width = w;
+      r.height = h;
+      cairo_region_union_rectangle (decoded, &r);
+    }
+  drop_tiles (x, y, w, h);
+  gtk_widget_queue_draw (picture);
+}
+
+static void
+loading_done (gboolean ok)
+{
+  GdkPixbufAnimation *anim;
+
+  if (ok)
+    {
+      /* whole image is decoded */
+      if (decoded)
+        {
+          cairo_region_destroy (decoded);
+          decoded = NULL;
+          gtk_widget_queue_draw (picture);
+        }
+
+      anim = gdk_pixbuf_loader_get_animation (loader);
+      if (anim && !gdk_pixbuf_animation_is_static_image (anim))
         {
-          GdkPixbuf *old_pb = gtk_image_get_pixbuf (GTK_IMAGE (picture));
-          gtk_image_set_from_pixbuf (GTK_IMAGE (picture), pb);
-          g_object_unref (old_pb);
+          /* animations are shown by GtkImage */
+          anim_pb = g_object_ref (anim);
+          gtk_widget_destroy (picture);
+          picture = gtk_image_new_from_animation (anim_pb);
+          gtk_container_add (GTK_CONTAINER (picture_box), picture);
+          gtk_widget_show (picture);
+          animated = TRUE;
+        }
+      else
+        {
+          if (reloading)
+            {
+              /* replace reduced image by full one */
+              set_image (gdk_pixbuf_loader_get_pixbuf (loader));
+              reduced = FALSE;
+              gtk_widget_queue_draw (picture);
+            }
+          g_ptr_array_ref (levels);
+          g_thread_unref (g_thread_new ("levels", build_levels_thread, levels));
         }
     }
+  else if (!loaded)
+    picture_failed ();
+
+  g_object_unref (loader);
+  loader = NULL;
+  reloading = FALSE;
+}
+
+/* feed loader by small portions, so dialog stays responsive */
+static gboolean
+read_picture_cb (gpointer data)
+{
+  guchar buf[PICTURE_READ_CHUNK];
+  gsize len;
+  gboolean ok = TRUE;
+
+  len = fread (buf, 1, PICTURE_READ_CHUNK, loader_input);
+  if (len > 0 && gdk_pixbuf_loader_write (loader, buf, len, NULL))
+    return TRUE;
+
+  if (ferror (loader_input) || len > 0)
+    ok = FALSE;
+  fclose (loader_input);
+  loader_input = NULL;
+
+  if (!gdk_pixbuf_loader_close (loader, NULL))
+    ok = FALSE;
+  loading_done (ok);
+
+  return FALSE;
 }
 
 static void
-change_size_cb (GtkWidget *w, gint type)
+start_loading ()
+{
+  loader_input = fopen (picture_file, "r");
+  if (!loader_input)
+    {
+      if (!loaded)
+        picture_failed ();
+      return;
+    }
+
+  loader = gdk_pixbuf_loader_new ();
+  g_signal_connect (G_OBJECT (loader), "size-prepared", G_CALLBACK (size_prepared_cb), NULL);
+  /* full size image for reload is shown only when complete */
+  if (!reloading)
+    {
+      g_signal_connect (G_OBJECT (loader), "area-prepared", G_CALLBACK (area_prepared_cb), NULL);
+      g_signal_connect (G_OBJECT (loader), "area-updated", G_CALLBACK (area_updated_cb), NULL);
+    }
+
+  g_idle_add (read_picture_cb, NULL);
+}
+
+static void
+load_picture (gchar *filename)
 {
-  gdouble width, height;
-  GdkPixbuf *new_pb, *pb = gtk_image_get_pixbuf (GTK_IMAGE (picture));
+  picture_file = g_strdup (filename);
 
-  if (!pb)
+  tiles = g_hash_table_new (g_int64_hash, g_int64_equal);
+  tiles_lru = g_queue_new ();
+
+  picture = gtk_drawing_area_new ();
+#if !GTK_CHECK_VERSION(3,0,0)
+  g_signal_connect (G_OBJECT (picture), "expose-event", G_CALLBACK (expose_cb), NULL);
+#else
+  g_signal_connect (G_OBJECT (picture), "draw", G_CALLBACK (draw_cb), NULL);
+#endif
+}
+
+/* reduced image isn't enough for requested scale */
+static void
+check_resolution ()
+{
+  if (reduced && !reloading && !loader &&
+      scale * image_width > gdk_pixbuf_get_width (orig_pb))
     {
-      g_printerr ("picture: can't get pixbuf\n");
+      reloading = TRUE;
+      start_loading ();
+    }
+}
+
+void
+picture_fit_to_window ()
+{
+  gdouble ww, wh;
+  gdouble factor;
+
+  if (animated)
+    return;
+
+  /* image size is unknown yet, fit it when it comes */
+  if (!loaded)
+    {
+      fit_pending = TRUE;
       return;
     }
+  fit_pending = FALSE;
+
+  ww = gdk_window_get_width (gtk_viewport_get_view_window (GTK_VIEWPORT (viewport)));
+  wh = gdk_window_get_height (gtk_viewport_get_view_window (GTK_VIEWPORT (viewport)));
+
+  factor = MIN (ww / orient_width, wh / orient_height);
+  scale = MIN (factor, 1.0);
+  update_picture_size ();
+  check_resolution ();
+}
+
+static void
+change_size_cb (GtkWidget *w, gint type)
+{
+  gdouble width;
 
-  width = gdk_pixbuf_get_width (pb);
-  height = gdk_pixbuf_get_height (pb);
+  /* new size is always computed from original image */
+  width = orient_width * scale;
 
   switch (type)
     {
     case SIZE_FIT:
       picture_fit_to_window ();
-      break;
+      return;
     case SIZE_ORIG:
-      gtk_image_set_from_pixbuf (GTK_IMAGE (picture), orig_pb);
-      g_object_unref (pb);
+      scale = 1.0;
       break;
     case SIZE_INC:
-      new_pb = gdk_pixbuf_scale_simple (pb, width + options.picture_data.inc,
-                                        height + options.picture_data.inc, GDK_INTERP_HYPER);
-      if (new_pb)
-        {
-          gtk_image_set_from_pixbuf (GTK_IMAGE (picture), new_pb);
-          g_object_unref (pb);
-        }
+      scale = (width + options.picture_data.inc) / orient_width;
       break;
     case SIZE_DEC:
-      new_pb = gdk_pixbuf_scale_simple (pb, width - options.picture_data.inc,
-                                        height - options.picture_data.inc, GDK_INTERP_HYPER);
-      if (new_pb)
-        {
-          gtk_image_set_from_pixbuf (GTK_IMAGE (picture), new_pb);
-          g_object_unref (pb);
-        }
+      if (width - options.picture_data.inc >= 1)
+        scale = (width - options.picture_data.inc) / orient_width;
       break;
     }
+
+  update_picture_size ();
+  check_resolution ();
 }
 
 static void
 rotate_cb (GtkWidget *w, gint type)
 {
-  GdkPixbuf *new_pb = NULL;
-  GdkPixbuf *pb = gtk_image_get_pixbuf (GTK_IMAGE (picture));
-
-  if (!pb)
-    {
-      g_printerr ("picture: can't get pixbuf\n");
-      return;
-    }
+  cairo_matrix_t m, res;
+  gint tmp;
 
+  /* rotation is applied while drawing, the image itself is unchanged */
   switch (type)
     {
     case ROTATE_LEFT:
-      new_pb = gdk_pixbuf_rotate_simple (pb, GDK_PIXBUF_ROTATE_COUNTERCLOCKWISE);
+      cairo_matrix_init (&m, 0, -1, 1, 0, 0, orient_width);
       break;
     case ROTATE_RIGHT:
-      new_pb = gdk_pixbuf_rotate_simple (pb, GDK_PIXBUF_ROTATE_CLOCKWISE);
+      cairo_matrix_init (&m, 0, 1, -1, 0, orient_height, 0);
       break;
     case ROTATE_FLIP_VERT:
-      new_pb = gdk_pixbuf_flip (pb, FALSE);
+      cairo_matrix_init (&m, 1, 0, 0, -1, 0, orient_height);
       break;
     case ROTATE_FLIP_HOR:
-      new_pb = gdk_pixbuf_flip (pb, TRUE);
+      cairo_matrix_init (&m, -1, 0, 0, 1, orient_width, 0);
       break;
+    default:
+      return;
     }
 
-  if (new_pb)
+  cairo_matrix_multiply (&res, &orient, &m);
+  orient = res;
+
+  if (type == ROTATE_LEFT || type == ROTATE_RIGHT)
     {
-      gtk_image_set_from_pixbuf (GTK_IMAGE (picture), new_pb);
-      g_object_unref (pb);
+      tmp = orient_width;
+      orient_width = orient_height;
+      orient_height = tmp;
     }
+
+  update_picture_size ();
 }
 
 static void
@@ -228,6 +699,9 @@ create_popup_menu ()
 static gboolean
 button_handler (GtkWidget *w, GdkEventButton *ev, gpointer data)
 {
+  if (!loaded || animated)
+    return FALSE;
+
   if (ev->button == 3)
     {
 #if GTK_CHECK_VERSION(3,22,0)
@@ -260,21 +734,21 @@ picture_create_widget (GtkWidget * dlg)
                                gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (sw)));
   gtk_container_add (GTK_CONTAINER (sw), viewport);
 
-  ev = gtk_event_box_new ();
+  picture_box = ev = gtk_event_box_new ();
   gtk_container_add (GTK_CONTAINER (viewport), ev);
 
-  picture = gtk_image_new ();
-  gtk_container_add (GTK_CONTAINER (ev), picture);
-
   /* load picture */
   if (options.common_data.uri &&
       g_file_test (options.common_data.uri, G_FILE_TEST_EXISTS))
     load_picture (options.common_data.uri);
   else
-    gtk_image_set_from_icon_name (GTK_IMAGE (picture), "image-missing", GTK_ICON_SIZE_DIALOG);
+    picture = gtk_image_new_from_icon_name ("image-missing", GTK_ICON_SIZE_DIALOG);
+  gtk_container_add (GTK_CONTAINER (ev), picture);
 
-  if (loaded && !animated)
+  if (picture_file)
     {
+      /* image is decoded in background */
+      start_loading ();
       create_popup_menu ();
       g_signal_connect (G_OBJECT (ev), "button-press-event", G_CALLBACK (button_handler), NULL);
       g_signal_connect (G_OBJECT (ev), "key-press-event", G_CALLBACK (key_handler), NULL);
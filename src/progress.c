@@ -17,222 +17,1101 @@
  * Copyright (C) 2008-2019, Victor Ananjevsky <ananasik@gmail.com>
  */
 
+#define _GNU_SOURCE
+
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <unistd.h>
 #include <signal.h>
 
-#include "yad.h"
+#include "yad.h"
+
+#define PROGRESS_FRAME_TIME 16
+#define PULSE_TIME 100
+
+/* maximum number of bars in multi-progress mode */
+#define MAX_BARS 1000
+
+/* smoothing time and minimal sampling interval of rate estimator, in seconds */
+#define RATE_TAU 3.0
+#define RATE_INTERVAL 0.25
+
+typedef struct {
+  GtkWidget *label;
+  GtkWidget *bar;
+  YadProgressType type;
+  gboolean pulsing;             /* started perm or auto-pulsate bar */
+  gboolean done;
+  gchar *user_text;
+  /* statistics */
+  gdouble value;
+  gdouble total;                /* zero if value is a percentage */
+  gdouble start_value;
+  gint64 start_time;
+  gint64 last_time;
+  gdouble rate;
+  gdouble rate_value;
+  gint64 rate_time;
+  /* pending changes */
+  gboolean dirty;
+  gdouble fraction;             /* negative if not changed */
+  gchar *text;
+  gboolean pulse;
+} YadProgressItem;
+
+static GtkWidget *progress_table;
+static GPtrArray *progress_bars = NULL;
+static GArray *dirty_bars = NULL;
+#if !GTK_CHECK_VERSION(3,0,0)
+static guint table_size = 0;
+#endif
+
+/* counters for auto-close */
+static guint ncountable = 0;
+static guint ndone = 0;
+
+static GtkWidget *progress_log;
+static GtkTextBuffer *log_buffer;
+static GtkTextMark *log_end;
+static GString *log_pending = NULL;
+static guint log_pending_lines = 0;
+
+static gboolean single_mode = FALSE;
+
+/* all pulsing bars are driven by one timer */
+static GSList *pulsing_bars = NULL;
+static guint pulse_timer = 0;
+static gboolean pulse_iconified = FALSE;
+static gboolean pulse_unmapped = TRUE;
+
+static guint update_id = 0;
+
+static gboolean
+pulse_bars_cb (gpointer data)
+{
+  GSList *l;
+
+  for (l = pulsing_bars; l; l = l->next)
+    gtk_progress_bar_pulse (GTK_PROGRESS_BAR (l->data));
+  return TRUE;
+}
+
+/* stop timer when there is nothing to show */
+static void
+update_pulse_timer ()
+{
+  gboolean need = pulsing_bars && !pulse_iconified && !pulse_unmapped;
+
+  if (need && pulse_timer == 0)
+    pulse_timer = g_timeout_add (PULSE_TIME, pulse_bars_cb, NULL);
+  else if (!need && pulse_timer > 0)
+    {
+      g_source_remove (pulse_timer);
+      pulse_timer = 0;
+    }
+}
+
+static void
+start_pulse (YadProgressItem *p)
+{
+  if (p->pulsing)
+    return;
+  p->pulsing = TRUE;
+  pulsing_bars = g_slist_prepend (pulsing_bars, p->bar);
+  update_pulse_timer ();
+}
+
+static void
+stop_pulse (YadProgressItem *p)
+{
+  if (!p->pulsing)
+    return;
+  p->pulsing = FALSE;
+  pulsing_bars = g_slist_remove (pulsing_bars, p->bar);
+  update_pulse_timer ();
+}
+
+static gboolean
+window_state_cb (GtkWidget *w, GdkEventWindowState *ev, gpointer data)
+{
+  pulse_iconified = (ev->new_window_state & GDK_WINDOW_STATE_ICONIFIED) != 0;
+  update_pulse_timer ();
+  return FALSE;
+}
+
+static void
+map_cb (GtkWidget *w, gpointer data)
+{
+  pulse_unmapped = GPOINTER_TO_INT (data);
+  update_pulse_timer ();
+}
+
+static YadProgressItem *
+get_bar (gint num)
+{
+  if (num < 0 || num >= progress_bars->len)
+    return NULL;
+  return (YadProgressItem *) g_ptr_array_index (progress_bars, num);
+}
+
+static void
+set_fraction (YadProgressItem *p, gdouble fraction)
+{
+  gboolean done = (fraction >= 1.0);
+
+  gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (p->bar), fraction);
+
+  if (p->type != YAD_PROGRESS_PULSE && p->done != done)
+    {
+      if (done)
+        ndone++;
+      else
+        ndone--;
+    }
+  p->done = done;
+}
+
+static void
+check_autoclose ()
+{
+  if (!options.progress_data.autoclose || options.plug != -1)
+    return;
+
+  /* Check if all of progress bars reaches 100% */
+  if (options.progress_data.watch_bar > 0 && options.progress_data.watch_bar <= progress_bars->len)
+    {
+      YadProgressItem *p = get_bar (options.progress_data.watch_bar - 1);
+
+      if (p && p->done)
+        yad_exit (options.data.def_resp);
+    }
+  else if (ncountable > 0 && ndone == ncountable)
+    yad_exit (options.data.def_resp);
+}
+
+/* exponentially smoothed rate of value change */
+static void
+update_rate (YadProgressItem *p, gdouble value, gdouble total)
+{
+  gint64 now = g_get_monotonic_time ();
+  gdouble dt, rate;
+
+  if (p->start_time == 0 || value < p->rate_value || total != p->total)
+    {
+      /* first value or the job was restarted */
+      p->start_time = p->rate_time = now;
+      p->start_value = p->rate_value = value;
+      p->rate = 0;
+    }
+  else
+    {
+      dt = (now - p->rate_time) / (gdouble) G_USEC_PER_SEC;
+      if (dt >= RATE_INTERVAL)
+        {
+          rate = (value - p->rate_value) / dt;
+          if (p->rate == 0)
+            p->rate = rate;
+          else
+            p->rate += (rate - p->rate) * dt / (dt + RATE_TAU);
+          p->rate_time = now;
+          p->rate_value = value;
+        }
+    }
+
+  p->last_time = now;
+  p->value = value;
+  p->total = total;
+}
+
+static gchar *
+format_time (gdouble sec)
+{
+  gulong t = sec + 0.5;
+
+  if (t >= 3600)
+    return g_strdup_printf ("%lu:%02lu:%02lu", t / 3600, (t / 60) % 60, t % 60);
+  return g_strdup_printf ("%lu:%02lu", t / 60, t % 60);
+}
+
+/* bar text with progress, rate and estimated time */
+static gchar *
+eta_text (YadProgressItem *p)
+{
+  GString *str = g_string_new (NULL);
+
+  if (p->user_text && *p->user_text)
+    g_string_append_printf (str, "%s: ", p->user_text);
+
+  if (p->total > 0)
+    g_string_append_printf (str, "%g/%g", p->value, p->total);
+  else
+    g_string_append_printf (str, "%.1f%%", p->value);
+
+  if (p->rate > 0)
+    {
+      gdouble left = (p->total > 0 ? p->total : 100.0) - p->value;
+
+      if (p->total > 0)
+        g_string_append_printf (str, _(", %.1f/s"), p->rate);
+      if (left > 0)
+        {
+          gchar *eta = format_time (left / p->rate);
+          g_string_append_printf (str, _(", ETA %s"), eta);
+          g_free (eta);
+        }
+    }
+
+  return g_string_free (str, FALSE);
+}
+
+/* apply pending changes of one bar */
+static gboolean
+apply_update (YadProgressItem *p)
+{
+  gboolean changed;
+
+  if (!p || !p->dirty)
+    return FALSE;
+
+  if (options.progress_data.eta)
+    {
+      if (p->text)
+        {
+          g_free (p->user_text);
+          p->user_text = p->text;
+          p->text = NULL;
+        }
+      if (!options.common_data.hide_text)
+        {
+          gchar *text = p->start_time ? eta_text (p) : g_strdup (p->user_text);
+          if (text)
+            gtk_progress_bar_set_text (GTK_PROGRESS_BAR (p->bar), text);
+          g_free (text);
+        }
+    }
+  else if (p->text)
+    {
+      gtk_progress_bar_set_text (GTK_PROGRESS_BAR (p->bar), p->text);
+      g_free (p->text);
+      p->text = NULL;
+    }
+  if (p->pulse)
+    gtk_progress_bar_pulse (GTK_PROGRESS_BAR (p->bar));
+
+  changed = p->fraction >= 0;
+  if (changed)
+    set_fraction (p, p->fraction);
+
+  p->fraction = -1;
+  p->pulse = FALSE;
+  p->dirty = FALSE;
+
+  return changed;
+}
+
+/* append buffered log lines with one insert and drop the oldest ones */
+static void
+apply_log ()
+{
+  GtkTextIter start, end;
+  gint max = options.progress_data.log_lines;
+  gint count;
+
+  if (log_pending_lines == 0)
+    return;
+
+  if (max > 0 && log_pending_lines > max)
+    {
+      gchar *p = log_pending->str;
+      guint n = log_pending_lines - max;
+
+      while (n--)
+        p = strchr (p, '\n') + 1;
+      g_string_erase (log_pending, 0, p - log_pending->str);
+    }
+
+  gtk_text_buffer_get_end_iter (log_buffer, &end);
+  gtk_text_buffer_insert (log_buffer, &end, log_pending->str, log_pending->len);
+  g_string_truncate (log_pending, 0);
+  log_pending_lines = 0;
+
+  /* last line is always empty */
+  count = gtk_text_buffer_get_line_count (log_buffer) - 1;
+  if (max > 0 && count > max)
+    {
+      gtk_text_buffer_get_start_iter (log_buffer, &start);
+      gtk_text_buffer_get_iter_at_line (log_buffer, &end, count - max);
+      gtk_text_buffer_delete (log_buffer, &start, &end);
+    }
+
+  gtk_text_view_scroll_to_mark (GTK_TEXT_VIEW (progress_log), log_end, 0, FALSE, 0, 0);
+}
+
+static void
+apply_updates ()
+{
+  guint i;
+  gboolean changed = FALSE;
+
+  if (options.progress_data.log)
+    apply_log ();
+
+  for (i = 0; i < dirty_bars->len; i++)
+    changed |= apply_update (get_bar (g_array_index (dirty_bars, gint, i)));
+  g_array_set_size (dirty_bars, 0);
+
+  if (changed)
+    check_autoclose ();
+}
+
+#if GTK_CHECK_VERSION(3,8,0)
+static gboolean
+update_tick_cb (GtkWidget *w, GdkFrameClock *clock, gpointer data)
+{
+  update_id = 0;
+  apply_updates ();
+  return FALSE;
+}
+#else
+static gboolean
+update_timeout_cb (gpointer data)
+{
+  update_id = 0;
+  apply_updates ();
+  return FALSE;
+}
+#endif
+
+/* changes are applied once per frame */
+static void
+schedule_updates ()
+{
+  if (update_id)
+    return;
+
+#if GTK_CHECK_VERSION(3,8,0)
+  update_id = gtk_widget_add_tick_callback (progress_table, update_tick_cb, NULL, NULL);
+#else
+  update_id = g_timeout_add (PROGRESS_FRAME_TIME, update_timeout_cb, NULL);
+#endif
+}
+
+static void
+schedule_update (gint num)
+{
+  YadProgressItem *p = get_bar (num);
+
+  if (!p->dirty)
+    {
+      p->dirty = TRUE;
+      g_array_append_val (dirty_bars, num);
+    }
+  schedule_updates ();
+}
+
+static void
+add_bar (gint num, const gchar *name, YadProgressType type, const gchar *extra)
+{
+  YadProgressItem *p;
+  GtkWidget *l, *w;
+
+  p = g_new0 (YadProgressItem, 1);
+  p->type = type;
+  p->fraction = -1;
+
+  if (num >= progress_bars->len)
+    g_ptr_array_set_size (progress_bars, num + 1);
+  g_ptr_array_index (progress_bars, num) = p;
+
+  if (type != YAD_PROGRESS_PULSE)
+    ncountable++;
+
+#if !GTK_CHECK_VERSION(3,0,0)
+  if (num >= table_size)
+    {
+      table_size = num + 1;
+      if (options.common_data.vertical)
+        gtk_table_resize (GTK_TABLE (progress_table), 2, table_size);
+      else
+        gtk_table_resize (GTK_TABLE (progress_table), table_size, 2);
+    }
+#endif
+
+  /* add label */
+  p->label = l = gtk_label_new (NULL);
+  if (options.data.no_markup)
+    gtk_label_set_text (GTK_LABEL (l), name);
+  else
+    gtk_label_set_markup (GTK_LABEL (l), name);
+#if !GTK_CHECK_VERSION(3,0,0)
+  gtk_misc_set_alignment (GTK_MISC (l), options.common_data.align, 0.5);
+#else
+  gtk_label_set_xalign (GTK_LABEL (l), options.common_data.align);
+#endif
+  if (options.common_data.vertical)
+#if !GTK_CHECK_VERSION(3,0,0)
+    gtk_table_attach (GTK_TABLE (progress_table), l, num, num + 1, 1, 2, GTK_FILL, 0, 2, 2);
+#else
+    gtk_grid_attach (GTK_GRID (progress_table), l, num, 1, 1, 1);
+#endif
+  else
+#if !GTK_CHECK_VERSION(3,0,0)
+    gtk_table_attach (GTK_TABLE (progress_table), l, 0, 1, num, num + 1, GTK_FILL, 0, 2, 2);
+#else
+    gtk_grid_attach (GTK_GRID (progress_table), l, 0, num, 1, 1);
+#endif
+
+  /* add progress bar */
+  p->bar = w = gtk_progress_bar_new ();
+  gtk_widget_set_name (w, "yad-progress-widget");
+#if GTK_CHECK_VERSION(3,0,0)
+  gtk_progress_bar_set_show_text (GTK_PROGRESS_BAR (w), !options.common_data.hide_text);
+#endif
+
+#if !GTK_CHECK_VERSION(3,0,0)
+  /* The maintain-gtk2 branch keeps forward compatibility with master for GTK 3 builds only */
+  /* Here maintain-gtk2 keeps backward compatibility */
+  if (single_mode)
+    {
+      if (options.progress_data.percentage > 100)
+        options.progress_data.percentage = 100;
+      set_fraction (p, options.progress_data.percentage / 100.0);
+
+      /* writes updatable text inside the bar */
+      if (options.progress_data.progress_text && !options.common_data.hide_text)
+        gtk_progress_bar_set_text (GTK_PROGRESS_BAR (w), options.progress_data.progress_text);
+    }
+#endif
+
+  if (extra && g_ascii_isdigit (*extra))
+    {
+      if (type != YAD_PROGRESS_PULSE)
+        set_fraction (p, atoi (extra) / 100.0);
+      else
+        gtk_progress_bar_set_pulse_step (GTK_PROGRESS_BAR (w), atoi (extra) / 100.0);
+    }
+
+#if GTK_CHECK_VERSION(3,0,0)
+  gtk_progress_bar_set_inverted (GTK_PROGRESS_BAR (w), type == YAD_PROGRESS_RTL);
+  if (options.common_data.vertical)
+    gtk_orientable_set_orientation (GTK_ORIENTABLE (w), GTK_ORIENTATION_VERTICAL);
+#else
+  if (type == YAD_PROGRESS_RTL)
+    {
+      if (options.common_data.vertical)
+        gtk_progress_bar_set_orientation (GTK_PROGRESS_BAR (w), GTK_PROGRESS_TOP_TO_BOTTOM);
+      else
+        gtk_progress_bar_set_orientation (GTK_PROGRESS_BAR (w), GTK_PROGRESS_RIGHT_TO_LEFT);
+    }
+  else
+    {
+      if (options.common_data.vertical)
+        gtk_progress_bar_set_orientation (GTK_PROGRESS_BAR (w), GTK_PROGRESS_BOTTOM_TO_TOP);
+    }
+#endif
+  if (options.common_data.vertical)
+    {
+#if !GTK_CHECK_VERSION(3,0,0)
+      gtk_table_attach (GTK_TABLE (progress_table), w, num, num + 1, 0, 1, 0, GTK_FILL | GTK_EXPAND, 2, 2);
+#else
+      gtk_grid_attach (GTK_GRID (progress_table), w, num, 0, 1, 1);
+      gtk_widget_set_vexpand (w, TRUE);
+#endif
+    }
+  else
+    {
+#if !GTK_CHECK_VERSION(3,0,0)
+      gtk_table_attach (GTK_TABLE (progress_table), w, 1, 2, num, num + 1, GTK_FILL | GTK_EXPAND, 0, 2, 2);
+#else
+      gtk_grid_attach (GTK_GRID (progress_table), w, 1, num, 1, 1);
+      gtk_widget_set_hexpand (w, TRUE);
+#endif
+    }
+
+  gtk_widget_show (l);
+  gtk_widget_show (w);
+}
+
+static void
+remove_bar (gint num)
+{
+  YadProgressItem *p = get_bar (num);
+
+  if (!p)
+    return;
+
+  stop_pulse (p);
+
+  if (p->type != YAD_PROGRESS_PULSE)
+    {
+      ncountable--;
+      if (p->done)
+        ndone--;
+    }
+
+  gtk_widget_destroy (p->label);
+  gtk_widget_destroy (p->bar);
+  g_free (p->text);
+  g_free (p->user_text);
+  g_free (p);
+
+  g_ptr_array_index (progress_bars, num) = NULL;
+}
+
+/* N:add:LABEL[:TYPE] and N:remove commands */
+static gboolean
+bar_command (gint num, gchar *str)
+{
+  if (strncmp (str, "add:", 4) == 0)
+    {
+      gchar **bstr = split_arg (str + 4);
+      YadProgressType type = YAD_PROGRESS_NORMAL;
+
+      strip_new_line (bstr[0]);
+      if (bstr[1])
+        {
+          strip_new_line (bstr[1]);
+          if (strcasecmp (bstr[1], "RTL") == 0)
+            type = YAD_PROGRESS_RTL;
+          else if (strcasecmp (bstr[1], "PULSE") == 0)
+            type = YAD_PROGRESS_PULSE;
+          else if (strcasecmp (bstr[1], "PERM") == 0)
+            type = YAD_PROGRESS_PERM;
+        }
+
+      remove_bar (num);
+      add_bar (num, bstr[0], type, NULL);
+      g_strfreev (bstr);
+    }
+  else if (strncmp (str, "remove", 6) == 0)
+    {
+      remove_bar (num);
+      check_autoclose ();
+    }
+  else
+    return FALSE;
+
+  return TRUE;
+}
+
+static void
+parse_line (gchar *line)
+{
+  gchar **value = NULL;
+  gchar *str;
+  gint num;
+  YadProgressItem *p;
+
+  if (single_mode)
+    {
+      str = line;
+      num = 0;
+    }
+  else
+    {
+      value = g_strsplit (line, ":", 2);
+      num = atoi (value[0]) - 1;
+      str = value[1];
+      if (num < 0 || num >= MAX_BARS || (str && bar_command (num, str)))
+        {
+          g_strfreev (value);
+          return;
+        }
+    }
+
+  p = get_bar (num);
+  if (!p)
+    {
+      g_strfreev (value);
+      return;
+    }
+
+  if (str && str[0] == '#')
+    {
+      gchar *match;
+
+      /* We have a comment, so let's try to change the label */
+      match = g_strcompress (str + 1);
+      strip_new_line (match);
+      if (options.progress_data.log)
+        {
+          g_string_append (log_pending, match);
+          g_string_append_c (log_pending, '\n');
+          log_pending_lines++;
+          schedule_updates ();
+          g_free (match);
+        }
+      else if (!options.common_data.hide_text)
+        {
+          /* only the last text matters */
+          g_free (p->text);
+          p->text = match;
+          schedule_update (num);
+        }
+      else
+        g_free (match);
+    }
+  else if (str)
+    {
+      if (options.progress_data.pulsate && p->type == YAD_PROGRESS_PULSE)
+        {
+          start_pulse (p);
+          p->pulse = TRUE;
+          schedule_update (num);
+        }
+      else if (p->type == YAD_PROGRESS_PULSE)
+        {
+          p->pulse = TRUE;
+          schedule_update (num);
+        }
+      else if (p->type == YAD_PROGRESS_PERM)
+        {
+          /* commands are applied in order, so flush pending changes first */
+          if (strncmp (str, "start", 5) == 0)
+            {
+              apply_update (p);
+              start_pulse (p);
+            }
+          else if (strncmp (str, "stop", 4) == 0)
+            {
+              apply_update (p);
+              stop_pulse (p);
+            }
+        }
+
+      /* step: in version 0.42.x single-progress pulsate can set its percentange,
+         which is desirable to be able to --auto-close the dialog at 100%.  There is no
+         harm to also let multi-progress PERM and PULSE bars set their percentage. */
+      if (g_ascii_isdigit (*str))
+        {
+          gchar *end;
+          gdouble val, total = 0;
+          gdouble fraction;
 
-static GSList *progress_bars = NULL;
-static guint nbars = 0;
+          /* value is a percentage or DONE/TOTAL */
+          val = g_ascii_strtod (str, &end);
+          if (*end == '/')
+            total = g_ascii_strtod (end + 1, NULL);
 
-static GtkWidget *progress_log;
-static GtkTextBuffer *log_buffer;
+          if (total > 0)
+            fraction = val / total;
+          else
+            fraction = val / 100.0;
+          update_rate (p, val, total);
 
-static gboolean single_mode = FALSE;
+          /* keep only the last value */
+          p->fraction = CLAMP (fraction, 0.0, 1.0);
+          schedule_update (num);
+        }
+    }
 
-static gboolean
-pulsate_progress_bar (GtkProgressBar *bar)
-{
-  gtk_progress_bar_pulse (bar);
-  return TRUE;
+  g_strfreev (value);
 }
 
+/* stdin, fifo and socket connections. each channel keeps its own partial line */
 static gboolean
-handle_stdin (GIOChannel *channel, GIOCondition condition, gpointer data)
+handle_input (GIOChannel *channel, GIOCondition condition, gpointer data)
 {
-  static guint single_mode_pulsate_timeout = 0;
-  float percentage = 0.0;
+  gboolean is_stdin = (g_io_channel_unix_get_fd (channel) == 0);
 
   if ((condition == G_IO_IN) || (condition == G_IO_IN + G_IO_HUP))
     {
       GString *string;
-      gchar **value;
       GError *err = NULL;
+      gint status;
 
       string = g_string_new (NULL);
 
       while (channel->is_readable != TRUE)
         usleep (100);
 
+      /* read everything available, changes will be shown on the next frame */
       do
         {
-          gint status, num;
-          GtkProgressBar *pb;
-          YadProgressBar *b;
+          status = g_io_channel_read_line_string (channel, string, NULL, &err);
+          if (status != G_IO_STATUS_NORMAL)
+            break;
+          parse_line (string->str);
+        }
+      while (g_io_channel_get_buffer_condition (channel) == G_IO_IN);
+      g_string_free (string, TRUE);
 
-          do
+      if (status == G_IO_STATUS_ERROR || status == G_IO_STATUS_EOF)
+        {
+          if (err)
             {
-              status = g_io_channel_read_line_string (channel, string, NULL, &err);
-
-              while (gtk_events_pending ())
-                gtk_main_iteration ();
+              g_printerr ("yad_multi_progress_handle_input(): %s\n", err->message);
+              g_error_free (err);
+              err = NULL;
             }
-          while (status == G_IO_STATUS_AGAIN);
+          /* stop handling */
+          g_io_channel_shutdown (channel, TRUE, NULL);
+          apply_updates ();
+          return FALSE;
+        }
+    }
 
-          if (status != G_IO_STATUS_NORMAL)
+  if ((condition != G_IO_IN) && (condition != G_IO_IN + G_IO_HUP))
+    {
+      g_io_channel_shutdown (channel, TRUE, NULL);
+      apply_updates ();
+
+      /* disconnected producers don't close the dialog */
+      if (is_stdin && options.progress_data.autoclose && options.plug == -1)
+         yad_exit (options.data.def_resp);
+
+      return FALSE;
+    }
+  return TRUE;
+}
+
+static void
+watch_input (gint fd)
+{
+  GIOChannel *channel;
+
+  channel = g_io_channel_unix_new (fd);
+  g_io_channel_set_encoding (channel, NULL, NULL);
+  g_io_channel_set_flags (channel, G_IO_FLAG_NONBLOCK, NULL);
+  g_io_add_watch (channel, G_IO_IN | G_IO_HUP, handle_input, NULL);
+  g_io_channel_unref (channel);
+}
+
+static gboolean
+accept_cb (GIOChannel *channel, GIOCondition condition, gpointer data)
+{
+  gint fd;
+
+  fd = accept (g_io_channel_unix_get_fd (channel), NULL, NULL);
+  if (fd >= 0)
+    watch_input (fd);
+  else if (errno != EINTR && errno != EAGAIN)
+    g_printerr ("accept(): %s\n", g_strerror (errno));
+
+  return TRUE;
+}
+
+static gboolean socket_created = FALSE;
+static gboolean fifo_created = FALSE;
+
+static void
+remove_inputs ()
+{
+  if (socket_created)
+    unlink (options.progress_data.socket);
+  if (fifo_created)
+    unlink (options.progress_data.fifo);
+}
+
+static void
+open_socket (const gchar *path)
+{
+  struct sockaddr_un addr;
+  struct stat st;
+  GIOChannel *channel;
+  gint fd;
+
+  if (strlen (path) >= sizeof (addr.sun_path))
+    {
+      g_printerr (_("Socket path is too long: %s\n"), path);
+      return;
+    }
+
+  fd = socket (AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    {
+      g_printerr (_("Cannot create socket %s: %s\n"), path, g_strerror (errno));
+      return;
+    }
+
+  memset (&addr, 0, sizeof (addr));
+  addr.sun_family = AF_UNIX;
+  strcpy (addr.sun_path, path);
+
+  /* remove stale socket, but never other files or socket of running instance */
+  if (lstat (path, &st) == 0)
+    {
+      gint tfd;
+      gboolean alive;
+
+      if (!S_ISSOCK (st.st_mode))
+        {
+          g_printerr (_("Cannot create socket %s: %s\n"), path, g_strerror (EEXIST));
+          close (fd);
+          return;
+        }
+
+      tfd = socket (AF_UNIX, SOCK_STREAM, 0);
+      alive = (tfd >= 0 && connect (tfd, (struct sockaddr *) &addr, sizeof (addr)) == 0);
+      if (tfd >= 0)
+        close (tfd);
+      if (alive)
+        {
+          g_printerr (_("Cannot create socket %s: %s\n"), path, g_strerror (EADDRINUSE));
+          close (fd);
+          return;
+        }
+      unlink (path);
+    }
+
+  if (bind (fd, (struct sockaddr *) &addr, sizeof (addr)) < 0 || listen (fd, SOMAXCONN) < 0)
+    {
+      g_printerr (_("Cannot create socket %s: %s\n"), path, g_strerror (errno));
+      close (fd);
+      return;
+    }
+
+  socket_created = TRUE;
+
+  channel = g_io_channel_unix_new (fd);
+  g_io_add_watch (channel, G_IO_IN, accept_cb, NULL);
+  g_io_channel_unref (channel);
+}
+
+static void
+open_fifo (const gchar *path)
+{
+  gint fd;
+
+  if (mkfifo (path, 0600) == 0)
+    fifo_created = TRUE;
+  else if (errno != EEXIST)
+    {
+      g_printerr (_("Cannot create fifo %s: %s\n"), path, g_strerror (errno));
+      return;
+    }
+
+  /* keep write end too, so the fifo never reaches EOF between writers */
+  fd = open (path, O_RDWR | O_NONBLOCK);
+  if (fd < 0)
+    {
+      g_printerr (_("Cannot open fifo %s: %s\n"), path, g_strerror (errno));
+      return;
+    }
+  watch_input (fd);
+}
+
+/* pass-through mode */
+#define PIPE_CHUNK 65536
+#define PIPE_UPDATE_TIME 250
+
+G_LOCK_DEFINE_STATIC (pipe_lock);
+static guint64 pipe_bytes = 0;
+static gboolean pipe_done = FALSE;
+
+static gchar *
+format_size (guint64 size)
+{
+#if GLIB_CHECK_VERSION(2,30,0)
+  return g_format_size_full (size, options.common_data.size_fmt);
+#else
+  return g_format_size_for_display (size);
+#endif
+}
+
+static void
+pipe_count (gssize n)
+{
+  G_LOCK (pipe_lock);
+  pipe_bytes += n;
+  G_UNLOCK (pipe_lock);
+}
+
+static gboolean
+write_all (gint fd, gchar *buf, gssize len)
+{
+  while (len > 0)
+    {
+      gssize n = write (fd, buf, len);
+      if (n < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          return FALSE;
+        }
+      buf += n;
+      len -= n;
+    }
+  return TRUE;
+}
+
+#ifdef __linux__
+/* move data in kernel. returns FALSE if splice is not supported for this files */
+static gboolean
+pipe_splice ()
+{
+  struct stat st;
+  gint p[2] = { -1, -1 };
+  gboolean direct, started = FALSE;
+  gssize n, m;
+
+  /* splice needs a pipe on one side, otherwise use an intermediate one */
+  direct = (fstat (0, &st) == 0 && S_ISFIFO (st.st_mode)) || (fstat (1, &st) == 0 && S_ISFIFO (st.st_mode));
+  if (!direct && pipe (p) < 0)
+    return FALSE;
+
+  for (;;)
+    {
+      n = splice (0, NULL, direct ? 1 : p[1], NULL, PIPE_CHUNK, SPLICE_F_MOVE | SPLICE_F_MORE);
+      if (n == 0)
+        break;
+      if (n < 0)
+        {
+          if (errno == EINTR || errno == EAGAIN)
+            continue;
+          break;
+        }
+
+      /* drain intermediate pipe */
+      m = n;
+      while (!direct && m > 0)
+        {
+          gssize k = splice (p[0], NULL, 1, NULL, m, SPLICE_F_MOVE | SPLICE_F_MORE);
+          if (k < 0 && errno == EINTR)
+            continue;
+          if (k == 0 || (k < 0 && errno == EINVAL && !started))
             {
-              if (err)
-                {
-                  g_printerr ("yad_multi_progress_handle_stdin(): %s\n", err->message);
-                  g_error_free (err);
-                  err = NULL;
-                }
-              /* stop handling */
-              g_io_channel_shutdown (channel, TRUE, NULL);
+              gchar buf[PIPE_CHUNK];
+
+              /* short splice or output doesn't support it, copy the rest by hand */
+              if (read (p[0], buf, m) != m || !write_all (1, buf, m))
+                goto out;
+              if (k == 0)
+                break;
+              pipe_count (n);
+              close (p[0]);
+              close (p[1]);
               return FALSE;
             }
+          if (k < 0)
+            goto out;
+          m -= k;
+        }
 
-          if (single_mode)
-            {
-              value = g_new0 (gchar *, 2);
-              value[1] = g_strdup (string->str);
-              num = 0;
-            }
-          else
-            {
-              value = g_strsplit (string->str, ":", 2);
-              num = atoi (value[0]) - 1;
-              if (num < 0 || num > nbars - 1)
-                continue;
-            }
+      started = TRUE;
+      pipe_count (n);
+    }
 
-          pb = GTK_PROGRESS_BAR (g_slist_nth_data (progress_bars, num));
-          b = (YadProgressBar *) g_slist_nth_data (options.progress_data.bars, num);
+  if (n < 0 && errno == EINVAL && !started)
+    {
+      if (!direct)
+        {
+          close (p[0]);
+          close (p[1]);
+        }
+      return FALSE;
+    }
 
-          if (value[1] && value[1][0] == '#')
-            {
-              gchar *match;
-
-              /* We have a comment, so let's try to change the label */
-              match = g_strcompress (value[1] + 1);
-              strip_new_line (match);
-              if (options.progress_data.log)
-                {
-                  gchar *logline;
-                  GtkTextIter end;
-
-                  logline = g_strdup_printf ("%s\n", match);    /* add new line */
-                  gtk_text_buffer_get_end_iter (log_buffer, &end);
-                  gtk_text_buffer_insert (log_buffer, &end, logline, -1);
-                  g_free (logline);
-
-                  /* scroll to end */
-                  while (gtk_events_pending ())
-                    gtk_main_iteration ();
-                  gtk_text_buffer_get_end_iter (log_buffer, &end);
-                  gtk_text_view_scroll_to_iter (GTK_TEXT_VIEW (progress_log), &end, 0, FALSE, 0, 0);
-                }
-              else
-                {
-                  if (!options.common_data.hide_text)
-                    gtk_progress_bar_set_text (pb, match);
-                }
-              g_free (match);
-            }
-          else
+ out:
+  if (!direct)
+    {
+      close (p[0]);
+      close (p[1]);
+    }
+  return TRUE;
+}
+#endif
+
+static gpointer
+pipe_thread (gpointer data)
+{
+  gint fd;
+
+#ifdef __linux__
+  if (!pipe_splice ())
+#endif
+    {
+      gchar buf[PIPE_CHUNK];
+      gssize n;
+
+      while ((n = read (0, buf, PIPE_CHUNK)) != 0)
+        {
+          if (n < 0)
             {
-              if (options.progress_data.pulsate && value[1] && b->type == YAD_PROGRESS_PULSE)
-                {
-                  if (single_mode_pulsate_timeout == 0)
-                    single_mode_pulsate_timeout = g_timeout_add (100, (GSourceFunc) pulsate_progress_bar, pb);
-                  gtk_progress_bar_pulse (pb);
-                }
-              else if (value[1] && b->type == YAD_PROGRESS_PULSE)
-                gtk_progress_bar_pulse (pb);
-              else if (value[1] && b->type == YAD_PROGRESS_PERM)
-                {
-                  guint id;
-
-                  if (strncmp (value[1], "start", 5) == 0)
-                    {
-                      id = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (pb), "id"));
-                      if (id == 0)
-                        {
-                          id = g_timeout_add (100, (GSourceFunc) pulsate_progress_bar, pb);
-                          g_object_set_data (G_OBJECT (pb), "id", GINT_TO_POINTER (id));
-                        }
-                    }
-                  else if (strncmp (value[1], "stop", 4) == 0)
-                    {
-                      id = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (pb), "id"));
-                      if (id > 0)
-                        {
-                          g_source_remove (id);
-                          g_object_set_data (G_OBJECT (pb), "id", GINT_TO_POINTER (0));
-                        }
-                    }
-                }
-
-              /* step: in version 0.42.x single-progress pulsate can set its percentange,
-              which is desirable to be able to --auto-close the dialog at 100%.  There is no
-              harm to also let multi-progress PERM and PULSE bars set their percentage. */
-                /*{*/
-                  if (!value[1] || !g_ascii_isdigit (*value[1]))
-                    continue;
-
-                  /* Now try to convert the thing to a number */
-                  percentage = atoi (value[1]);
-                  if (percentage >= 100)
-                    gtk_progress_bar_set_fraction (pb, 1.0);
-                  else
-                    gtk_progress_bar_set_fraction (pb, percentage / 100.0);
-
-                  /* Check if all of progress bars reaches 100% */
-                  if (options.progress_data.autoclose && options.plug == -1)
-                    {
-                      guint i;
-                      gboolean close = TRUE;
-                      gboolean need_close = FALSE;
-
-                      if (options.progress_data.watch_bar > 0 && options.progress_data.watch_bar <= nbars)
-                        {
-                          GtkProgressBar *cpb = GTK_PROGRESS_BAR (g_slist_nth_data (progress_bars,
-                                                                                    options.progress_data.watch_bar - 1));
-
-                          need_close = TRUE;
-                          if (gtk_progress_bar_get_fraction (cpb) != 1.0)
-                            close = FALSE;
-                        }
-                      else
-                        {
-                          for (i = 0; i < nbars; i++)
-                            {
-                              GtkProgressBar *cpb = GTK_PROGRESS_BAR (g_slist_nth_data (progress_bars, i));
-                              YadProgressBar *cb = (YadProgressBar *) g_slist_nth_data (options.progress_data.bars, i);
-
-                              if (cb->type != YAD_PROGRESS_PULSE)
-                                {
-                                  need_close = TRUE;
-                                  if (gtk_progress_bar_get_fraction (cpb) != 1.0)
-                                    {
-                                      close = FALSE;
-                                      break;
-                                    }
-                                }
-                            }
-                        }
-
-                      if (need_close && close)
-                        yad_exit (options.data.def_resp);
-                    }
-                /*}*/
+              if (errno == EINTR || errno == EAGAIN)
+                continue;
+              break;
             }
+          if (!write_all (1, buf, n))
+            break;
+          pipe_count (n);
         }
-      while (g_io_channel_get_buffer_condition (channel) == G_IO_IN);
-      g_string_free (string, TRUE);
     }
 
-  if ((condition != G_IO_IN) && (condition != G_IO_IN + G_IO_HUP))
+  /* let the reader see end of data */
+  fd = open ("/dev/null", O_WRONLY);
+  dup2 (fd, 1);
+  close (fd);
+
+  G_LOCK (pipe_lock);
+  pipe_done = TRUE;
+  G_UNLOCK (pipe_lock);
+
+  return NULL;
+}
+
+static gboolean
+pipe_update_cb (gpointer data)
+{
+  YadProgressItem *p = get_bar (0);
+  guint64 bytes, size = options.progress_data.pipe_size;
+  gboolean done;
+  GString *str;
+  gchar *s;
+
+  G_LOCK (pipe_lock);
+  bytes = pipe_bytes;
+  done = pipe_done;
+  G_UNLOCK (pipe_lock);
+
+  if (!p)
+    return !done;
+
+  update_rate (p, bytes, size);
+
+  str = g_string_new (NULL);
+  s = format_size (bytes);
+  g_string_append (str, s);
+  g_free (s);
+  if (size > 0)
     {
-      g_io_channel_shutdown (channel, TRUE, NULL);
+      s = format_size (size);
+      g_string_append_printf (str, " / %s", s);
+      g_free (s);
+    }
+  if (p->rate > 0 && !done)
+    {
+      s = format_size (p->rate);
+      g_string_append_printf (str, ", %s/s", s);
+      g_free (s);
+      if (size > bytes)
+        {
+          s = format_time ((size - bytes) / p->rate);
+          g_string_append_printf (str, _(", ETA %s"), s);
+          g_free (s);
+        }
+    }
+  if (!options.common_data.hide_text)
+    gtk_progress_bar_set_text (GTK_PROGRESS_BAR (p->bar), str->str);
+  g_string_free (str, TRUE);
 
-      if (options.progress_data.autoclose && options.plug == -1)
-         yad_exit (options.data.def_resp);
+  if (done)
+    set_fraction (p, 1.0);
+  else if (size > 0)
+    set_fraction (p, MIN ((gdouble) bytes / size, 1.0));
+  else
+    gtk_progress_bar_pulse (GTK_PROGRESS_BAR (p->bar));
 
+  if (done)
+    {
+      check_autoclose ();
       return FALSE;
     }
   return TRUE;
@@ -241,13 +1120,13 @@ handle_stdin (GIOChannel *channel, GIOCondition condition, gpointer data)
 GtkWidget *
 progress_create_widget (GtkWidget *dlg)
 {
-  GtkWidget *table;
+  GtkWidget *w, *box;
   GIOChannel *channel;
   GSList *b;
+  guint nextra = 0;
   gint i = 0;
 
-  nbars = g_slist_length (options.progress_data.bars);
-  if (nbars < 1)
+  if (options.progress_data.bars == NULL)
     {
       YadProgressBar *bar = g_new0 (YadProgressBar, 1);
 
@@ -269,153 +1148,68 @@ progress_create_widget (GtkWidget *dlg)
 #endif
 
       options.progress_data.bars = g_slist_append (options.progress_data.bars, bar);
-      nbars = 1;
 
       options.progress_data.watch_bar = 1;
 
       single_mode = TRUE;
     }
 
+  progress_bars = g_ptr_array_new ();
+  dirty_bars = g_array_new (FALSE, FALSE, sizeof (gint));
+
+#if GTK_CHECK_VERSION(3,0,0)
+  box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 2);
+#else
+  box = gtk_vbox_new (FALSE, 2);
+#endif
+
 #if !GTK_CHECK_VERSION(3,0,0)
+  table_size = g_slist_length (options.progress_data.bars);
   if (options.common_data.vertical)
-    table = gtk_table_new (2, nbars, FALSE);
+    progress_table = gtk_table_new (2, table_size, FALSE);
   else
-    table = gtk_table_new (nbars, 2, FALSE);
+    progress_table = gtk_table_new (table_size, 2, FALSE);
 #else
-  table = gtk_grid_new ();
-  gtk_grid_set_row_spacing (GTK_GRID (table), 2);
-  gtk_grid_set_column_spacing (GTK_GRID (table), 2);
+  progress_table = gtk_grid_new ();
+  gtk_grid_set_row_spacing (GTK_GRID (progress_table), 2);
+  gtk_grid_set_column_spacing (GTK_GRID (progress_table), 2);
 #endif
 
-  for (b = options.progress_data.bars; b; b = b->next)
+  if (options.common_data.scroll)
     {
-      GtkWidget *l, *w;
-      YadProgressBar *p = (YadProgressBar *) b->data;
-
-      /* add label */
-      l = gtk_label_new (NULL);
-      if (options.data.no_markup)
-        gtk_label_set_text (GTK_LABEL (l), p->name);
-      else
-        gtk_label_set_markup (GTK_LABEL (l), p->name);
-#if !GTK_CHECK_VERSION(3,0,0)
-      gtk_misc_set_alignment (GTK_MISC (l), options.common_data.align, 0.5);
-#else
-      gtk_label_set_xalign (GTK_LABEL (l), options.common_data.align);
-#endif
-      if (options.common_data.vertical)
+      w = gtk_scrolled_window_new (NULL, NULL);
+      gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (w), GTK_SHADOW_NONE);
+      gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (w), options.hscroll_policy, options.vscroll_policy);
 #if !GTK_CHECK_VERSION(3,0,0)
-        gtk_table_attach (GTK_TABLE (table), l, i, i + 1, 1, 2, GTK_FILL, 0, 2, 2);
+      gtk_scrolled_window_add_with_viewport (GTK_SCROLLED_WINDOW (w), progress_table);
 #else
-        gtk_grid_attach (GTK_GRID (table), l, i, 1, 1, 1);
+      gtk_container_add (GTK_CONTAINER (w), progress_table);
 #endif
-      else
-#if !GTK_CHECK_VERSION(3,0,0)
-        gtk_table_attach (GTK_TABLE (table), l, 0, 1, i, i + 1, GTK_FILL, 0, 2, 2);
-#else
-        gtk_grid_attach (GTK_GRID (table), l, 0, i, 1, 1);
-#endif
-
-      /* add progress bar */
-      w = gtk_progress_bar_new ();
-      gtk_widget_set_name (w, "yad-progress-widget");
-#if GTK_CHECK_VERSION(3,0,0)
-      gtk_progress_bar_set_show_text (GTK_PROGRESS_BAR (w), !options.common_data.hide_text);
-#endif
-
-#if !GTK_CHECK_VERSION(3,0,0)
-      /* The maintain-gtk2 branch keeps forward compatibility with master for GTK 3 builds only */
-      /* Here maintain-gtk2 keeps backward compatibility */
-      if (single_mode)
-        {
-          if (options.progress_data.percentage > 100)
-            options.progress_data.percentage = 100;
-          gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (w), options.progress_data.percentage / 100.0);
-
-          /* writes updatable text inside the bar */
-          if (options.progress_data.progress_text && !options.common_data.hide_text)
-            gtk_progress_bar_set_text (GTK_PROGRESS_BAR (w), options.progress_data.progress_text);
-        }
-#endif
-
-      if (p->type != YAD_PROGRESS_PULSE)
-        {
-          if (options.extra_data && options.extra_data[i])
-            {
-              if (g_ascii_isdigit (*options.extra_data[i]))
-                gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (w), atoi (options.extra_data[i]) / 100.0);
-            }
-        }
-      else
-        {
-          if (options.extra_data && options.extra_data[i])
-            {
-              if (g_ascii_isdigit (*options.extra_data[i]))
-                gtk_progress_bar_set_pulse_step (GTK_PROGRESS_BAR (w), atoi (options.extra_data[i]) / 100.0);
-            }
-        }
+      gtk_box_pack_start (GTK_BOX (box), w, TRUE, TRUE, 0);
+    }
+  else
+    gtk_box_pack_start (GTK_BOX (box), progress_table, TRUE, TRUE, 0);
 
-#if GTK_CHECK_VERSION(3,0,0)
-      gtk_progress_bar_set_inverted (GTK_PROGRESS_BAR (w), p->type == YAD_PROGRESS_RTL);
-      if (options.common_data.vertical)
-        gtk_orientable_set_orientation (GTK_ORIENTABLE (w), GTK_ORIENTATION_VERTICAL);
-#else
-      if (p->type == YAD_PROGRESS_RTL)
-        {
-          if (options.common_data.vertical)
-            gtk_progress_bar_set_orientation (GTK_PROGRESS_BAR (w), GTK_PROGRESS_TOP_TO_BOTTOM);
-          else
-            gtk_progress_bar_set_orientation (GTK_PROGRESS_BAR (w), GTK_PROGRESS_RIGHT_TO_LEFT);
-        }
-      else
-        {
-          if (options.common_data.vertical)
-            gtk_progress_bar_set_orientation (GTK_PROGRESS_BAR (w), GTK_PROGRESS_BOTTOM_TO_TOP);
-        }
-#endif
-      if (options.common_data.vertical)
-        {
-#if !GTK_CHECK_VERSION(3,0,0)
-          gtk_table_attach (GTK_TABLE (table), w, i, i + 1, 0, 1, 0, GTK_FILL | GTK_EXPAND, 2, 2);
-#else
-          gtk_grid_attach (GTK_GRID (table), w, i, 0, 1, 1);
-          gtk_widget_set_vexpand (w, TRUE);
-#endif
-        }
-      else
-        {
-#if !GTK_CHECK_VERSION(3,0,0)
-          gtk_table_attach (GTK_TABLE (table), w, 1, 2, i, i + 1, GTK_FILL | GTK_EXPAND, 0, 2, 2);
-#else
-          gtk_grid_attach (GTK_GRID (table), w, 1, i, 1, 1);
-          gtk_widget_set_hexpand (w, TRUE);
-#endif
-        }
+  if (options.extra_data)
+    nextra = g_strv_length (options.extra_data);
 
-      progress_bars = g_slist_append (progress_bars, w);
+  for (b = options.progress_data.bars; b; b = b->next)
+    {
+      YadProgressBar *p = (YadProgressBar *) b->data;
 
+      add_bar (i, p->name, p->type, i < nextra ? options.extra_data[i] : NULL);
       i++;
     }
 
   if (options.progress_data.log)
     {
       GtkWidget *ex, *sw;
+      GtkTextIter end;
 
       ex = gtk_expander_new (options.progress_data.log);
       gtk_expander_set_spacing (GTK_EXPANDER (ex), 2);
       gtk_expander_set_expanded (GTK_EXPANDER (ex), options.progress_data.log_expanded);
-
-#if !GTK_CHECK_VERSION(3,0,0)
-      if (options.common_data.vertical)
-        gtk_table_attach (GTK_TABLE (table), ex, 0, i + 1, 1, 2, GTK_FILL, 0, 2, 2);
-      else
-        gtk_table_attach (GTK_TABLE (table), ex, 0, 2, i, i + 1, GTK_FILL, 0, 2, 2);
-#else
-      if (options.common_data.vertical)
-        gtk_grid_attach (GTK_GRID (table), ex, 0, 2, i, 1);
-      else
-        gtk_grid_attach (GTK_GRID (table), ex, 0, i, 2, 1);
-#endif
+      gtk_box_pack_start (GTK_BOX (box), ex, FALSE, FALSE, 2);
 
       sw = gtk_scrolled_window_new (NULL, NULL);
       gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (sw), GTK_SHADOW_ETCHED_IN);
@@ -436,12 +1230,67 @@ progress_create_widget (GtkWidget *dlg)
       gtk_text_view_set_right_margin (GTK_TEXT_VIEW (progress_log), 5);
       gtk_text_view_set_editable (GTK_TEXT_VIEW (progress_log), FALSE);
       gtk_text_view_set_cursor_visible (GTK_TEXT_VIEW (progress_log), FALSE);
+
+      gtk_text_buffer_get_end_iter (log_buffer, &end);
+      log_end = gtk_text_buffer_create_mark (log_buffer, NULL, &end, FALSE);
+      log_pending = g_string_new (NULL);
     }
 
-  channel = g_io_channel_unix_new (0);
-  g_io_channel_set_encoding (channel, NULL, NULL);
-  g_io_channel_set_flags (channel, G_IO_FLAG_NONBLOCK, NULL);
-  g_io_add_watch (channel, G_IO_IN | G_IO_HUP, handle_stdin, dlg);
+  /* pause animation while bars are not visible */
+  g_signal_connect (G_OBJECT (box), "map", G_CALLBACK (map_cb), GINT_TO_POINTER (FALSE));
+  g_signal_connect (G_OBJECT (box), "unmap", G_CALLBACK (map_cb), GINT_TO_POINTER (TRUE));
+  g_signal_connect (G_OBJECT (dlg), "window-state-event", G_CALLBACK (window_state_cb), NULL);
+
+  if (options.progress_data.pipe)
+    {
+      /* copy stdin to stdout and count bytes */
+      g_thread_unref (g_thread_new ("pipe", pipe_thread, NULL));
+      g_timeout_add (PIPE_UPDATE_TIME, pipe_update_cb, NULL);
+    }
+  else
+    {
+      channel = g_io_channel_unix_new (0);
+      g_io_channel_set_encoding (channel, NULL, NULL);
+      g_io_channel_set_flags (channel, G_IO_FLAG_NONBLOCK, NULL);
+      g_io_add_watch (channel, G_IO_IN | G_IO_HUP, handle_input, dlg);
+    }
+
+  /* additional inputs for many producers */
+  if (options.progress_data.socket)
+    open_socket (options.progress_data.socket);
+  if (options.progress_data.fifo)
+    open_fifo (options.progress_data.fifo);
+  if (options.progress_data.socket || options.progress_data.fifo)
+    atexit (remove_inputs);
+
+  return box;
+}
+
+void
+progress_print_stats (void)
+{
+  guint i;
 
-  return table;
+  for (i = 0; i < progress_bars->len; i++)
+    {
+      YadProgressItem *p = get_bar (i);
+      gdouble elapsed;
+
+      if (!p || p->start_time == 0)
+        continue;
+
+      elapsed = (p->last_time - p->start_time) / (gdouble) G_USEC_PER_SEC;
+      if (p->total > 0)
+        g_printerr (_("bar %d: %g/%g in %.2f s"), i + 1, p->value, p->total, elapsed);
+      else
+        g_printerr (_("bar %d: %.1f%% in %.2f s"), i + 1, p->value, elapsed);
+      if (elapsed > 0)
+        {
+          if (p->total > 0)
+            g_printerr (_(", %.1f/s on average"), (p->value - p->start_value) / elapsed);
+          else
+            g_printerr (_(", %.2f%%/s on average"), (p->value - p->start_value) / elapsed);
+        }
+      g_printerr ("\n");
+    }
 }
@@ -18,6 +18,9 @@
  */
 
 #include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <pango/pango.h>
 
@@ -27,62 +30,471 @@ static GtkWidget *text_view;
 static GObject *text_buffer;
 static GtkTextTag *tag;
 static GdkCursor *hand, *normal;
-static gchar *pattern = NULL;
-static gboolean new_search = TRUE;
+
+#define PRINT_CHUNK 65536
 
 /* searching */
+#define SEARCH_BATCH 256
+
+typedef struct {
+  gint start;
+  gint end;
+} SearchMatch;
+
+typedef struct {
+  gchar *text;
+  gchar *pattern;
+  YadSearchType type;
+  gint base;                    /* offset of the text in buffer */
+  gint gen;
+} SearchJob;
+
+typedef struct {
+  GArray *matches;
+  gboolean done;
+  gchar *error;
+  gint gen;
+} SearchBatch;
+
+static gchar *pattern = NULL;
+static GtkTextTag *search_tag = NULL;
+static GtkWidget *search_label = NULL;
+static GArray *search_matches = NULL;
+static gint search_cur = -1;
+static gint search_from = 0;
+static guint search_applied = 0;
+static guint search_apply_id = 0;
+static gboolean search_done = TRUE;
+static gboolean search_dirty = TRUE;
+static gint search_scanned = 0;          /* end of text given to search */
+static gboolean search_tail = FALSE;     /* text was appended after search_scanned */
+static gchar *search_error = NULL;
+static volatile gint search_gen = 0;
+
 static void
-do_search (GtkWidget * e, GtkWidget * w)
+search_update_label ()
 {
-  static gchar *text = NULL;
-  static guint offset;
-  static GRegex *regex = NULL;
-  GMatchInfo *match = NULL;
+  gchar *str;
+
+  if (search_label == NULL)
+    return;
+
+  if (search_error)
+    {
+      gtk_label_set_text (GTK_LABEL (search_label), _("error"));
+      gtk_widget_set_tooltip_text (search_label, search_error);
+      return;
+    }
+
+  gtk_widget_set_tooltip_text (search_label, NULL);
+  str = g_strdup_printf (search_done && !search_tail ? "%d/%d" : "%d/%d+", search_cur + 1, search_matches->len);
+  gtk_label_set_text (GTK_LABEL (search_label), str);
+  g_free (str);
+}
+
+static void
+search_highlight (guint i)
+{
+  SearchMatch *sm = &g_array_index (search_matches, SearchMatch, i);
+  GtkTextIter begin, end;
+
+  gtk_text_buffer_get_iter_at_offset (GTK_TEXT_BUFFER (text_buffer), &begin, sm->start);
+  gtk_text_buffer_get_iter_at_offset (GTK_TEXT_BUFFER (text_buffer), &end, sm->end);
+  gtk_text_buffer_apply_tag (GTK_TEXT_BUFFER (text_buffer), search_tag, &begin, &end);
+}
+
+static void
+search_select (gint i)
+{
+  SearchMatch *sm = &g_array_index (search_matches, SearchMatch, i);
   GtkTextIter begin, end;
 
-  g_free (pattern);
-  pattern = g_strdup (gtk_entry_get_text (GTK_ENTRY (e)));
-  gtk_widget_destroy (w);
-  gtk_widget_queue_draw (text_view);
+  search_cur = i;
 
-  if (new_search || gtk_text_buffer_get_modified (GTK_TEXT_BUFFER (text_buffer)))
+  gtk_text_buffer_get_iter_at_offset (GTK_TEXT_BUFFER (text_buffer), &begin, sm->start);
+  gtk_text_buffer_get_iter_at_offset (GTK_TEXT_BUFFER (text_buffer), &end, sm->end);
+  gtk_text_buffer_select_range (GTK_TEXT_BUFFER (text_buffer), &begin, &end);
+  gtk_text_view_scroll_to_mark (GTK_TEXT_VIEW (text_view), gtk_text_buffer_get_insert (GTK_TEXT_BUFFER (text_buffer)),
+                                0.0, TRUE, 0.0, 0.5);
+}
+
+static gboolean
+search_apply_cb (gpointer data)
+{
+  guint n = 0;
+
+  /* highlight the rest of matches in document order, a portion per idle call */
+  while (search_applied < search_matches->len && n < SEARCH_BATCH)
     {
-      /* get the text */
-      g_free (text);
-      gtk_text_buffer_get_bounds (GTK_TEXT_BUFFER (text_buffer), &begin, &end);
-      text = gtk_text_buffer_get_text (GTK_TEXT_BUFFER (text_buffer), &begin, &end, FALSE);
-      offset = 0;
-      /* compile new regex */
+      search_highlight (search_applied);
+      search_applied++;
+      n++;
+    }
+
+  if (search_applied < search_matches->len)
+    return TRUE;
+
+  search_apply_id = 0;
+  return FALSE;
+}
+
+static gboolean
+search_batch_cb (SearchBatch * b)
+{
+  if (b->gen == g_atomic_int_get (&search_gen))
+    {
+      GdkRectangle rect;
+      GtkTextIter iter;
+      gint vstart, vend;
+      guint i, first;
+
+      first = search_matches->len;
+      g_array_append_vals (search_matches, b->matches->data, b->matches->len);
+
+      /* matches on the screen are highlighted at once */
+      gtk_text_view_get_visible_rect (GTK_TEXT_VIEW (text_view), &rect);
+      gtk_text_view_get_iter_at_location (GTK_TEXT_VIEW (text_view), &iter, rect.x, rect.y);
+      vstart = gtk_text_iter_get_offset (&iter);
+      gtk_text_view_get_iter_at_location (GTK_TEXT_VIEW (text_view), &iter, rect.x + rect.width, rect.y + rect.height);
+      gtk_text_iter_forward_to_line_end (&iter);
+      vend = gtk_text_iter_get_offset (&iter);
+
+      for (i = first; i < search_matches->len; i++)
+        {
+          SearchMatch *sm = &g_array_index (search_matches, SearchMatch, i);
+
+          if (sm->start > vend)
+            break;
+          if (sm->end >= vstart)
+            search_highlight (i);
+        }
+
+      /* select first match after cursor */
+      if (search_cur < 0)
+        {
+          for (i = first; i < search_matches->len; i++)
+            {
+              if (g_array_index (search_matches, SearchMatch, i).start >= search_from)
+                {
+                  search_select (i);
+                  break;
+                }
+            }
+        }
+
+      if (b->done)
+        {
+          search_done = TRUE;
+          search_error = b->error;
+          b->error = NULL;
+          if (search_cur < 0 && search_matches->len > 0)
+            search_select (0);
+        }
+
+      if (search_apply_id == 0 && search_applied < search_matches->len)
+        search_apply_id = g_idle_add (search_apply_cb, NULL);
+
+      search_update_label ();
+    }
+
+  g_array_free (b->matches, TRUE);
+  g_free (b->error);
+  g_free (b);
+
+  return FALSE;
+}
+
+static void
+search_push (SearchJob * job, GArray * matches, gboolean done, gchar * error)
+{
+  SearchBatch *b = g_new0 (SearchBatch, 1);
+
+  b->matches = matches;
+  b->done = done;
+  b->error = error;
+  b->gen = job->gen;
+  g_idle_add ((GSourceFunc) search_batch_cb, b);
+}
+
+static gpointer
+search_thread (SearchJob * job)
+{
+  GArray *matches;
+  const gchar *last;
+  glong offset = 0;
+  gchar *error = NULL;
+
+  matches = g_array_sized_new (FALSE, FALSE, sizeof (SearchMatch), SEARCH_BATCH);
+  last = job->text;
+  offset = job->base;
+
+  if (job->type == YAD_SEARCH_LITERAL)
+    {
+      const gchar *pos = job->text;
+      gsize len = strlen (job->pattern);
+
+      while ((pos = strstr (pos, job->pattern)) != NULL)
+        {
+          SearchMatch sm;
+
+          if (job->gen != g_atomic_int_get (&search_gen))
+            break;
+
+          /* positions are in bytes, not character, so here we must normalize it */
+          offset += g_utf8_pointer_to_offset (last, pos);
+          sm.start = offset;
+          sm.end = offset + g_utf8_strlen (pos, len);
+          last = pos;
+          pos += len;
+
+          g_array_append_val (matches, sm);
+          if (matches->len == SEARCH_BATCH)
+            {
+              search_push (job, matches, FALSE, NULL);
+              matches = g_array_sized_new (FALSE, FALSE, sizeof (SearchMatch), SEARCH_BATCH);
+            }
+        }
+    }
+  else
+    {
+      GRegex *regex;
+      GMatchInfo *match = NULL;
+      GError *err = NULL;
+
+      if (job->type == YAD_SEARCH_CASELESS)
+        {
+          gchar *str = g_regex_escape_string (job->pattern, -1);
+          regex = g_regex_new (str, G_REGEX_CASELESS | G_REGEX_OPTIMIZE, G_REGEX_MATCH_NOTEMPTY, &err);
+          g_free (str);
+        }
+      else
+        regex = g_regex_new (job->pattern, G_REGEX_EXTENDED | G_REGEX_OPTIMIZE, G_REGEX_MATCH_NOTEMPTY, &err);
+
       if (regex)
-        g_regex_unref (regex);
-      regex = g_regex_new (pattern, G_REGEX_EXTENDED | G_REGEX_OPTIMIZE, G_REGEX_MATCH_NOTEMPTY, NULL);
-      new_search = FALSE;
+        {
+          g_regex_match (regex, job->text, G_REGEX_MATCH_NOTEMPTY, &match);
+          while (g_match_info_matches (match))
+            {
+              SearchMatch sm;
+              gint sp, ep;
+
+              if (job->gen != g_atomic_int_get (&search_gen))
+                break;
+
+              g_match_info_fetch_pos (match, 0, &sp, &ep);
+
+              offset += g_utf8_pointer_to_offset (last, job->text + sp);
+              sm.start = offset;
+              sm.end = offset + g_utf8_pointer_to_offset (job->text + sp, job->text + ep);
+              last = job->text + sp;
+
+              g_array_append_val (matches, sm);
+              if (matches->len == SEARCH_BATCH)
+                {
+                  search_push (job, matches, FALSE, NULL);
+                  matches = g_array_sized_new (FALSE, FALSE, sizeof (SearchMatch), SEARCH_BATCH);
+                }
+
+              g_match_info_next (match, NULL);
+            }
+          g_match_info_free (match);
+          g_regex_unref (regex);
+        }
+      else
+        {
+          error = g_strdup (err->message);
+          g_error_free (err);
+        }
     }
 
-  /* search and select if found */
-  if (g_regex_match (regex, text + offset, G_REGEX_MATCH_NOTEMPTY, &match))
+  search_push (job, matches, TRUE, error);
+
+  g_free (job->text);
+  g_free (job->pattern);
+  g_free (job);
+
+  return NULL;
+}
+
+/* search in the snapshot of the text from begin to the end */
+static void
+search_run (GtkTextIter * begin)
+{
+  GtkTextIter end;
+  SearchJob *job;
+
+  search_done = FALSE;
+  search_tail = FALSE;
+
+  job = g_new0 (SearchJob, 1);
+  gtk_text_buffer_get_end_iter (GTK_TEXT_BUFFER (text_buffer), &end);
+  job->text = gtk_text_buffer_get_text (GTK_TEXT_BUFFER (text_buffer), begin, &end, TRUE);
+  job->pattern = g_strdup (pattern);
+  job->type = options.text_data.search_type;
+  job->base = gtk_text_iter_get_offset (begin);
+  job->gen = g_atomic_int_get (&search_gen);
+  search_scanned = gtk_text_iter_get_offset (&end);
+
+  g_thread_unref (g_thread_new ("search", (GThreadFunc) search_thread, job));
+
+  search_update_label ();
+}
+
+static void
+search_start ()
+{
+  GtkTextIter begin, end;
+
+  /* cancel running search */
+  g_atomic_int_inc (&search_gen);
+
+  if (search_apply_id)
+    {
+      g_source_remove (search_apply_id);
+      search_apply_id = 0;
+    }
+
+  gtk_text_buffer_get_bounds (GTK_TEXT_BUFFER (text_buffer), &begin, &end);
+  gtk_text_buffer_remove_tag (GTK_TEXT_BUFFER (text_buffer), search_tag, &begin, &end);
+
+  g_array_set_size (search_matches, 0);
+  search_cur = -1;
+  search_applied = 0;
+  search_dirty = FALSE;
+  search_tail = FALSE;
+  g_free (search_error);
+  search_error = NULL;
+
+  if (pattern == NULL || pattern[0] == '\0')
+    {
+      search_done = TRUE;
+      search_update_label ();
+      return;
+    }
+
+  gtk_text_buffer_get_iter_at_mark (GTK_TEXT_BUFFER (text_buffer), &begin,
+                                    gtk_text_buffer_get_insert (GTK_TEXT_BUFFER (text_buffer)));
+  search_from = gtk_text_iter_get_offset (&begin);
+
+  gtk_text_buffer_get_start_iter (GTK_TEXT_BUFFER (text_buffer), &begin);
+  search_run (&begin);
+}
+
+/* search only in appended text. the last line is searched again,
+ * because match may continue in the new text */
+static void
+search_continue ()
+{
+  GtkTextIter begin, end;
+  gint cut;
+  guint n;
+
+  gtk_text_buffer_get_iter_at_offset (GTK_TEXT_BUFFER (text_buffer), &begin, search_scanned);
+  gtk_text_iter_set_line_offset (&begin, 0);
+  cut = gtk_text_iter_get_offset (&begin);
+
+  for (n = search_matches->len; n > 0; n--)
+    {
+      if (g_array_index (search_matches, SearchMatch, n - 1).start < cut)
+        break;
+    }
+  g_array_set_size (search_matches, n);
+  search_applied = MIN (search_applied, n);
+  if (search_cur >= (gint) n)
+    {
+      search_cur = -1;
+      search_from = cut;
+    }
+
+  gtk_text_buffer_get_end_iter (GTK_TEXT_BUFFER (text_buffer), &end);
+  gtk_text_buffer_remove_tag (GTK_TEXT_BUFFER (text_buffer), search_tag, &begin, &end);
+
+  search_run (&begin);
+}
+
+static void
+search_step (gboolean backward)
+{
+  gint n;
+
+  if (search_dirty)
     {
-      gint sp, ep, spos, epos;
+      search_start ();
+      return;
+    }
+  if (search_tail && search_done && pattern && pattern[0])
+    search_continue ();
+
+  n = search_matches->len;
+  if (n == 0)
+    return;
+
+  if (backward)
+    search_select (search_cur > 0 ? search_cur - 1 : n - 1);
+  else if (search_cur + 1 < n)
+    search_select (search_cur + 1);
+  else if (search_done)
+    search_select (0);
+
+  search_update_label ();
+}
 
-      g_match_info_fetch_pos (match, 0, &sp, &ep);
+static void
+set_pattern (GtkWidget * e)
+{
+  const gchar *str = gtk_entry_get_text (GTK_ENTRY (e));
 
-      /* positions are in bytes, not character, so here we must normalize it */
-      spos = g_utf8_pointer_to_offset (text, text + sp + offset);
-      epos = g_utf8_pointer_to_offset (text, text + ep + offset);
+  if (g_strcmp0 (pattern, str) != 0)
+    {
+      g_free (pattern);
+      pattern = g_strdup (str);
+      search_dirty = TRUE;
+    }
+}
 
-      gtk_text_buffer_get_iter_at_offset (GTK_TEXT_BUFFER (text_buffer), &begin, spos);
-      gtk_text_buffer_get_iter_at_offset (GTK_TEXT_BUFFER (text_buffer), &end, epos);
+static void
+do_search (GtkWidget * e, gpointer d)
+{
+  set_pattern (e);
+  search_step (FALSE);
+}
 
-      gtk_text_buffer_select_range (GTK_TEXT_BUFFER (text_buffer), &begin, &end);
-      gtk_text_view_scroll_to_iter (GTK_TEXT_VIEW (text_view), &begin, 0, FALSE, 0, 0);
+static void
+search_invalidate ()
+{
+  search_dirty = TRUE;
 
-      offset += epos;
+  /* offsets of found matches are not valid anymore */
+  g_atomic_int_inc (&search_gen);
+  if (search_apply_id)
+    {
+      g_source_remove (search_apply_id);
+      search_apply_id = 0;
+    }
+  if (!search_done)
+    {
+      search_done = TRUE;
+      search_update_label ();
+    }
+}
 
-      g_match_info_free (match);
-      match = NULL;
+static void
+buffer_insert_cb (GtkTextBuffer * buf, GtkTextIter * pos, gchar * text, gint len, gpointer d)
+{
+  /* appending doesn't move found matches, so only the new text must be searched */
+  if (!search_dirty && gtk_text_iter_get_offset (pos) >= search_scanned)
+    {
+      search_tail = TRUE;
+      search_update_label ();
     }
   else
-    new_search = TRUE;
+    search_invalidate ();
+}
+
+static void
+buffer_delete_cb (GtkTextBuffer * buf, GtkTextIter * start, GtkTextIter * end, gpointer d)
+{
+  search_invalidate ();
 }
 
 static gboolean
@@ -96,16 +508,38 @@ search_key_cb (GtkWidget * w, GdkEventKey * key, GtkWidget * win)
   return FALSE;
 }
 
+static gboolean
+search_entry_key_cb (GtkWidget * e, GdkEventKey * key, gpointer d)
+{
+  switch (key->keyval)
+    {
+    case GDK_KEY_Return:
+    case GDK_KEY_KP_Enter:
+      if (!(key->state & GDK_SHIFT_MASK))
+        return FALSE;
+      /* fall through */
+    case GDK_KEY_Up:
+      set_pattern (e);
+      search_step (TRUE);
+      return TRUE;
+    case GDK_KEY_Down:
+      do_search (e, NULL);
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
 static void
-search_changed (GtkWidget * w, gpointer d)
+search_destroy_cb (GtkWidget * w, gpointer d)
 {
-  new_search = TRUE;
+  search_label = NULL;
 }
 
 static void
 show_search ()
 {
-  GtkWidget *w, *f, *e;
+  GtkWidget *w, *f, *b, *e;
   GdkEvent *fev;
 
   w = gtk_window_new (GTK_WINDOW_POPUP);
@@ -116,174 +550,808 @@ show_search ()
   gtk_window_set_modal (GTK_WINDOW (w), TRUE);
 
   g_signal_connect (G_OBJECT (w), "key-press-event", G_CALLBACK (search_key_cb), w);
+  g_signal_connect (G_OBJECT (w), "destroy", G_CALLBACK (search_destroy_cb), NULL);
+
+  f = gtk_frame_new (NULL);
+  gtk_frame_set_shadow_type (GTK_FRAME (f), GTK_SHADOW_ETCHED_IN);
+  gtk_container_set_border_width (GTK_CONTAINER (f), 1);
+  gtk_container_add (GTK_CONTAINER (w), f);
+
+#if !GTK_CHECK_VERSION(3,0,0)
+  b = gtk_hbox_new (FALSE, 5);
+#else
+  b = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 5);
+#endif
+  gtk_container_add (GTK_CONTAINER (f), b);
+
+  e = gtk_entry_new ();
+  if (pattern)
+    gtk_entry_set_text (GTK_ENTRY (e), pattern);
+  gtk_box_pack_start (GTK_BOX (b), e, TRUE, TRUE, 0);
+
+  search_label = gtk_label_new (NULL);
+  gtk_box_pack_start (GTK_BOX (b), search_label, FALSE, FALSE, 2);
+  if (!search_dirty)
+    search_update_label ();
+
+  g_signal_connect (G_OBJECT (e), "activate", G_CALLBACK (do_search), NULL);
+  g_signal_connect (G_OBJECT (e), "key-press-event", G_CALLBACK (search_entry_key_cb), NULL);
+
+  gtk_widget_show_all (w);
+
+  /* send focus event to search entry (so complex due to popup window) */
+  fev = gdk_event_new (GDK_FOCUS_CHANGE);
+  fev->focus_change.type = GDK_FOCUS_CHANGE;
+  fev->focus_change.in = TRUE;
+  fev->focus_change.window = gtk_widget_get_window (e);
+  if (fev->focus_change.window != NULL)
+    g_object_ref (fev->focus_change.window);
+  gtk_widget_send_focus_change (e, fev);
+  gdk_event_free (fev);
+}
+
+static gboolean
+key_press_cb (GtkWidget * w, GdkEventKey * key, gpointer data)
+{
+  if ((key->state & GDK_CONTROL_MASK) && (key->keyval == GDK_KEY_S || key->keyval == GDK_KEY_s))
+    {
+      show_search ();
+      return TRUE;
+    }
+  else if (key->keyval == GDK_KEY_F3 && pattern)
+    {
+      search_step (key->state & GDK_SHIFT_MASK);
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+tag_event_cb (GtkTextTag * tag, GObject * obj, GdkEvent * ev, GtkTextIter * iter, gpointer d)
+{
+  GtkTextIter start = *iter;
+  GtkTextIter end = *iter;
+  gchar *url;
+
+  if (ev->type == GDK_BUTTON_PRESS)
+    {
+      GdkEventButton *bev = (GdkEventButton *) ev;
+
+      if (bev->button == 1)
+        {
+          gtk_text_iter_backward_to_tag_toggle (&start, tag);
+          gtk_text_iter_forward_to_tag_toggle (&end, tag);
+
+          url = gtk_text_iter_get_text (&start, &end);
+          open_uri (url);
+          g_free (url);
+
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+static gboolean hovering_over_link = FALSE;
+
+static gboolean
+motion_cb (GtkWidget * w, GdkEventMotion * ev, gpointer d)
+{
+  gint x, y;
+  GSList *tags = NULL, *tagp = NULL;
+  GtkTextIter iter;
+  gboolean hovering = FALSE;
+
+  gtk_text_view_window_to_buffer_coords (GTK_TEXT_VIEW (w), GTK_TEXT_WINDOW_WIDGET, ev->x, ev->y, &x, &y);
+
+  gtk_text_view_get_iter_at_location (GTK_TEXT_VIEW (w), &iter, x, y);
+
+  tags = gtk_text_iter_get_tags (&iter);
+  for (tagp = tags; tagp != NULL; tagp = tagp->next)
+    {
+      GtkTextTag *tag = tagp->data;
+      gint link = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (tag), "is_link"));
+
+      if (link)
+        {
+          hovering = TRUE;
+          break;
+        }
+    }
+
+  if (hovering != hovering_over_link)
+    {
+      hovering_over_link = hovering;
+
+      if (hovering_over_link)
+        gdk_window_set_cursor (gtk_text_view_get_window (GTK_TEXT_VIEW (w), GTK_TEXT_WINDOW_TEXT), hand);
+      else
+        gdk_window_set_cursor (gtk_text_view_get_window (GTK_TEXT_VIEW (w), GTK_TEXT_WINDOW_TEXT), normal);
+    }
+
+  if (tags)
+    g_slist_free (tags);
+
+  return FALSE;
+}
+
+static void
+linkify_cb (GtkTextBuffer * buf, GRegex * regex)
+{
+  gchar *text;
+  GtkTextIter start, end;
+  GMatchInfo *match;
+
+  gtk_text_buffer_get_bounds (buf, &start, &end);
+  text = gtk_text_buffer_get_text (buf, &start, &end, FALSE);
+
+  gtk_text_buffer_remove_tag (buf, tag, &start, &end);
+
+  if (g_regex_match (regex, text, G_REGEX_MATCH_NOTEMPTY, &match))
+    {
+      do
+        {
+          gint sp, ep, spos, epos;
+
+          g_match_info_fetch_pos (match, 0, &sp, &ep);
+
+          /* positions are in bytes, not character, so here we must normalize it */
+          spos = g_utf8_pointer_to_offset (text, text + sp);
+          epos = g_utf8_pointer_to_offset (text, text + ep);
+
+          gtk_text_buffer_get_iter_at_offset (buf, &start, spos);
+          gtk_text_buffer_get_iter_at_offset (buf, &end, epos);
+
+          gtk_text_buffer_apply_tag (buf, tag, &start, &end);
+        }
+      while (g_match_info_next (match, NULL));
+    }
+  g_match_info_free (match);
+
+  g_free (text);
+}
+
+/* ANSI colors */
+#define ANSI_BOLD       (1 << 0)
+#define ANSI_ITALIC     (1 << 1)
+#define ANSI_UNDERLINE  (1 << 2)
+#define ANSI_REVERSE    (1 << 3)
+#define ANSI_STRIKE     (1 << 4)
+
+#define ANSI_RGB        0x1000000
+
+/* unterminated escape sequences longer than this are shown as text */
+#define ANSI_MAX_PENDING 512
+
+typedef struct {
+  gint fg;                      /* -1 - default, 0-255 - palette index, ANSI_RGB | rrggbb - direct color */
+  gint bg;
+  guint flags;
+} AnsiAttrs;
+
+static AnsiAttrs ansi = { -1, -1, 0 };
+static GtkTextTag *ansi_tag = NULL;
+static GHashTable *ansi_tags = NULL;
+static GString *ansi_pending = NULL;
+
+static const gchar *ansi_base_colors[] = {
+  "#000000", "#cd0000", "#00cd00", "#cdcd00", "#0000ee", "#cd00cd", "#00cdcd", "#e5e5e5",
+  "#7f7f7f", "#ff0000", "#00ff00", "#ffff00", "#5c5cff", "#ff00ff", "#00ffff", "#ffffff"
+};
+
+static gchar *
+ansi_color (gint clr)
+{
+  static const gint levels[] = { 0, 95, 135, 175, 215, 255 };
+
+  if (clr & ANSI_RGB)
+    return g_strdup_printf ("#%06x", clr & 0xffffff);
+  if (clr < 16)
+    return g_strdup (ansi_base_colors[clr]);
+  if (clr < 232)
+    {
+      clr -= 16;
+      return g_strdup_printf ("#%02x%02x%02x", levels[clr / 36], levels[(clr / 6) % 6], levels[clr % 6]);
+    }
+  clr = 8 + (clr - 232) * 10;
+  return g_strdup_printf ("#%02x%02x%02x", clr, clr, clr);
+}
+
+/* get tag for current attributes. tags are shared between all spans with the same attributes */
+static GtkTextTag *
+ansi_get_tag ()
+{
+  GtkTextTag *t;
+  gchar *key, *clr;
+  gint fg, bg;
+
+  if (ansi.fg < 0 && ansi.bg < 0 && ansi.flags == 0)
+    return NULL;
+
+  key = g_strdup_printf ("%x:%x:%x", ansi.fg, ansi.bg, ansi.flags);
+  t = g_hash_table_lookup (ansi_tags, key);
+  if (t)
+    {
+      g_free (key);
+      return t;
+    }
+
+  t = gtk_text_buffer_create_tag (GTK_TEXT_BUFFER (text_buffer), NULL, NULL);
+
+  fg = ansi.fg;
+  bg = ansi.bg;
+  if (ansi.flags & ANSI_REVERSE)
+    {
+      fg = ansi.bg;
+      bg = ansi.fg;
+      if (fg < 0)
+        g_object_set (G_OBJECT (t), "foreground", options.text_data.back ? options.text_data.back : "white", NULL);
+      if (bg < 0)
+        g_object_set (G_OBJECT (t), "background", options.text_data.fore ? options.text_data.fore : "black", NULL);
+    }
+
+  if (fg >= 0)
+    {
+      clr = ansi_color (fg);
+      g_object_set (G_OBJECT (t), "foreground", clr, NULL);
+      g_free (clr);
+    }
+  if (bg >= 0)
+    {
+      clr = ansi_color (bg);
+      g_object_set (G_OBJECT (t), "background", clr, NULL);
+      g_free (clr);
+    }
+
+  if (ansi.flags & ANSI_BOLD)
+    g_object_set (G_OBJECT (t), "weight", PANGO_WEIGHT_BOLD, NULL);
+  if (ansi.flags & ANSI_ITALIC)
+    g_object_set (G_OBJECT (t), "style", PANGO_STYLE_ITALIC, NULL);
+  if (ansi.flags & ANSI_UNDERLINE)
+    g_object_set (G_OBJECT (t), "underline", PANGO_UNDERLINE_SINGLE, NULL);
+  if (ansi.flags & ANSI_STRIKE)
+    g_object_set (G_OBJECT (t), "strikethrough", TRUE, NULL);
+
+  /* keep search highlighting above colors */
+  gtk_text_tag_set_priority (search_tag,
+                             gtk_text_tag_table_get_size (gtk_text_buffer_get_tag_table (GTK_TEXT_BUFFER (text_buffer))) - 1);
+
+  g_hash_table_insert (ansi_tags, key, t);
+
+  return t;
+}
+
+static gint
+ansi_extended_color (gint *args, gint n, gint *i)
+{
+  gint clr = -1;
+
+  if (*i + 2 < n && args[*i + 1] == 5)
+    {
+      clr = args[*i + 2] & 0xff;
+      *i += 2;
+    }
+  else if (*i + 4 < n && args[*i + 1] == 2)
+    {
+      clr = ANSI_RGB | ((args[*i + 2] & 0xff) << 16) | ((args[*i + 3] & 0xff) << 8) | (args[*i + 4] & 0xff);
+      *i += 4;
+    }
+
+  return clr;
+}
+
+/* parse parameters of SGR sequence. str points to the first parameter */
+static void
+ansi_sgr (const gchar * str)
+{
+  gint args[32];
+  gint i, n = 0;
+
+  args[0] = 0;
+  for (;; str++)
+    {
+      if (g_ascii_isdigit (*str))
+        {
+          if (args[n] <= 65535)
+            args[n] = args[n] * 10 + (*str - '0');
+        }
+      else if ((*str == ';' || *str == ':') && n < G_N_ELEMENTS (args) - 1)
+        args[++n] = 0;
+      else if (*str != ';' && *str != ':')
+        break;
+    }
+  n++;
+
+  for (i = 0; i < n; i++)
+    {
+      gint a = args[i];
+
+      if (a == 0)
+        {
+          ansi.fg = ansi.bg = -1;
+          ansi.flags = 0;
+        }
+      else if (a == 1)
+        ansi.flags |= ANSI_BOLD;
+      else if (a == 3)
+        ansi.flags |= ANSI_ITALIC;
+      else if (a == 4)
+        ansi.flags |= ANSI_UNDERLINE;
+      else if (a == 7)
+        ansi.flags |= ANSI_REVERSE;
+      else if (a == 9)
+        ansi.flags |= ANSI_STRIKE;
+      else if (a == 22)
+        ansi.flags &= ~ANSI_BOLD;
+      else if (a == 23)
+        ansi.flags &= ~ANSI_ITALIC;
+      else if (a == 24)
+        ansi.flags &= ~ANSI_UNDERLINE;
+      else if (a == 27)
+        ansi.flags &= ~ANSI_REVERSE;
+      else if (a == 29)
+        ansi.flags &= ~ANSI_STRIKE;
+      else if (a >= 30 && a <= 37)
+        ansi.fg = a - 30;
+      else if (a == 38)
+        ansi.fg = ansi_extended_color (args, n, &i);
+      else if (a == 39)
+        ansi.fg = -1;
+      else if (a >= 40 && a <= 47)
+        ansi.bg = a - 40;
+      else if (a == 48)
+        ansi.bg = ansi_extended_color (args, n, &i);
+      else if (a == 49)
+        ansi.bg = -1;
+      else if (a >= 90 && a <= 97)
+        ansi.fg = a - 90 + 8;
+      else if (a >= 100 && a <= 107)
+        ansi.bg = a - 100 + 8;
+    }
+
+  ansi_tag = ansi_get_tag ();
+}
+
+/* handle escape sequence at str. returns pointer to the rest of data or NULL if sequence is incomplete */
+static const gchar *
+ansi_parse (const gchar * str, const gchar * end)
+{
+  const gchar *p;
+
+  if (str + 1 >= end)
+    return NULL;
+
+  switch (str[1])
+    {
+    case '[':
+      /* CSI sequence */
+      for (p = str + 2; p < end; p++)
+        {
+          if (*p >= 0x40 && *p <= 0x7e)
+            {
+              if (*p == 'm')
+                ansi_sgr (str + 2);
+              return p + 1;
+            }
+          if (*p < 0x20 || *p > 0x3f)
+            return str + 1;     /* broken sequence, skip ESC */
+        }
+      return NULL;
+    case ']':
+      /* OSC sequence, terminated by BEL or ST */
+      for (p = str + 2; p < end; p++)
+        {
+          if (*p == '\007')
+            return p + 1;
+          if (*p == '\033')
+            {
+              if (p + 1 >= end)
+                return NULL;
+              return p + (p[1] == '\\' ? 2 : 0);
+            }
+        }
+      return NULL;
+    case '(':
+    case ')':
+      /* charset designation */
+      if (str + 3 > end)
+        return NULL;
+      return (guchar) str[2] < 0x80 ? str + 3 : str + 2;
+    default:
+      /* two-byte sequence. don't split multibyte character after ESC */
+      return (guchar) str[1] < 0x80 ? str + 2 : str + 1;
+    }
+}
+
+static void
+insert_text (GtkTextIter * iter, const gchar * str, gsize len)
+{
+  if (ansi_tag)
+    gtk_text_buffer_insert_with_tags (GTK_TEXT_BUFFER (text_buffer), iter, str, len, ansi_tag, NULL);
+  else
+    gtk_text_buffer_insert (GTK_TEXT_BUFFER (text_buffer), iter, str, len);
+}
+
+/* append chunk of utf-8 text to the end of buffer */
+static void
+text_append (const gchar * str, gsize len)
+{
+  GtkTextIter iter;
+  const gchar *p, *run, *end;
+  gchar *tmp = NULL;
+
+  gtk_text_buffer_get_end_iter (GTK_TEXT_BUFFER (text_buffer), &iter);
+
+  if (!options.text_data.ansi)
+    {
+      gtk_text_buffer_insert (GTK_TEXT_BUFFER (text_buffer), &iter, str, len);
+      return;
+    }
+
+  /* prepend the tail of escape sequence from previous chunk */
+  if (ansi_pending->len > 0)
+    {
+      g_string_append_len (ansi_pending, str, len);
+      len = ansi_pending->len;
+      str = tmp = g_string_free (ansi_pending, FALSE);
+      ansi_pending = g_string_new (NULL);
+    }
+
+  end = str + len;
+  run = str;
+  while ((p = memchr (run, '\033', end - run)) != NULL)
+    {
+      if (p > run)
+        insert_text (&iter, run, p - run);
+
+      run = ansi_parse (p, end);
+      if (run == NULL && end - p > ANSI_MAX_PENDING)
+        {
+          /* sequence is never terminated, show it as is */
+          insert_text (&iter, p, 1);
+          run = p + 1;
+        }
+      else if (run == NULL)
+        {
+          /* incomplete sequence - wait for the next chunk */
+          g_string_append_len (ansi_pending, p, end - p);
+          run = end;
+          break;
+        }
+    }
+
+  if (run < end)
+    insert_text (&iter, run, end - run);
+
+  g_free (tmp);
+}
+
+static void
+scroll_to_end ()
+{
+  static GtkTextMark *mark = NULL;
+  GtkTextIter end;
+
+  gtk_text_buffer_get_end_iter (GTK_TEXT_BUFFER (text_buffer), &end);
+  if (mark == NULL)
+    mark = gtk_text_buffer_create_mark (GTK_TEXT_BUFFER (text_buffer), NULL, &end, FALSE);
+  else
+    gtk_text_buffer_move_mark (GTK_TEXT_BUFFER (text_buffer), mark, &end);
+  gtk_text_view_scroll_to_mark (GTK_TEXT_VIEW (text_view), mark, 0, FALSE, 0, 0);
+}
 
-  f = gtk_frame_new (NULL);
-  gtk_frame_set_shadow_type (GTK_FRAME (f), GTK_SHADOW_ETCHED_IN);
-  gtk_container_set_border_width (GTK_CONTAINER (f), 1);
-  gtk_container_add (GTK_CONTAINER (w), f);
+/* input streams */
+#define READ_CHUNK 65536
 
-  e = gtk_entry_new ();
-  if (pattern)
-    gtk_entry_set_text (GTK_ENTRY (e), pattern);
-  gtk_container_add (GTK_CONTAINER (f), e);
+typedef struct {
+  GIConv conv;
+  gint unit;                    /* size of code unit in input encoding */
+  gboolean checked;
+  GString *rest;                /* incomplete sequence from previous chunk */
+  gboolean form_feed;           /* clear text on ^L */
+  gboolean skip_line;
+} TextStream;
 
-  g_signal_connect (G_OBJECT (e), "activate", G_CALLBACK (do_search), w);
-  g_signal_connect (G_OBJECT (e), "changed", G_CALLBACK (search_changed), NULL);
-  g_signal_connect (G_OBJECT (e), "key-press-event", G_CALLBACK (search_key_cb), w);
+static TextStream *
+stream_new (gboolean form_feed)
+{
+  TextStream *s = g_new0 (TextStream, 1);
 
-  gtk_widget_show_all (w);
+  s->conv = (GIConv) -1;
+  s->unit = 1;
+  s->rest = g_string_new (NULL);
+  s->form_feed = form_feed;
 
-  /* send focus event to search entry (so complex due to popup window) */
-  fev = gdk_event_new (GDK_FOCUS_CHANGE);
-  fev->focus_change.type = GDK_FOCUS_CHANGE;
-  fev->focus_change.in = TRUE;
-  fev->focus_change.window = gtk_widget_get_window (e);
-  if (fev->focus_change.window != NULL)
-    g_object_ref (fev->focus_change.window);
-  gtk_widget_send_focus_change (e, fev);
-  gdk_event_free (fev);
+  return s;
 }
 
-static gboolean
-key_press_cb (GtkWidget * w, GdkEventKey * key, gpointer data)
+static void
+stream_reset (TextStream * s)
 {
-  if ((key->state & GDK_CONTROL_MASK) && (key->keyval == GDK_KEY_S || key->keyval == GDK_KEY_s))
-    {
-      show_search ();
-      return TRUE;
-    }
-
-  return FALSE;
+  g_string_truncate (s->rest, 0);
+  if (s->conv != (GIConv) -1)
+    g_iconv (s->conv, NULL, NULL, NULL, NULL);
+  s->skip_line = FALSE;
 }
 
-static gboolean
-tag_event_cb (GtkTextTag * tag, GObject * obj, GdkEvent * ev, GtkTextIter * iter, gpointer d)
+/* output converted text */
+static void
+stream_output (TextStream * s, const gchar * str, gsize len)
 {
-  GtkTextIter start = *iter;
-  GtkTextIter end = *iter;
-  gchar *url;
+  const gchar *p, *end = str + len;
 
-  if (ev->type == GDK_BUTTON_PRESS)
+  if (!s->form_feed)
     {
-      GdkEventButton *bev = (GdkEventButton *) ev;
+      text_append (str, len);
+      return;
+    }
 
-      if (bev->button == 1)
+  while (str < end)
+    {
+      if (s->skip_line)
         {
-          gtk_text_iter_backward_to_tag_toggle (&start, tag);
-          gtk_text_iter_forward_to_tag_toggle (&end, tag);
+          /* ignore the rest of line after ^L */
+          p = memchr (str, '\n', end - str);
+          if (p == NULL)
+            return;
+          str = p + 1;
+          s->skip_line = FALSE;
+          continue;
+        }
 
-          url = gtk_text_iter_get_text (&start, &end);
-          open_uri (url);
-          g_free (url);
+      p = memchr (str, '\014', end - str);
+      if (p == NULL)
+        {
+          text_append (str, end - str);
+          return;
+        }
+      else
+        {
+          GtkTextIter start, bend;
 
-          return TRUE;
+          if (p > str)
+            text_append (str, p - str);
+
+          /* clear text if ^L received */
+          gtk_text_buffer_get_bounds (GTK_TEXT_BUFFER (text_buffer), &start, &bend);
+          gtk_text_buffer_delete (GTK_TEXT_BUFFER (text_buffer), &start, &bend);
+
+          str = p + 1;
+          s->skip_line = TRUE;
         }
     }
-
-  return FALSE;
 }
 
-static gboolean hovering_over_link = FALSE;
-
-static gboolean
-motion_cb (GtkWidget * w, GdkEventMotion * ev, gpointer d)
+/* output utf-8 data, invalid bytes are taken as latin-1. returns size of incomplete character at the end */
+static gsize
+stream_output_utf8 (TextStream * s, const gchar * buf, gsize len)
 {
-  gint x, y;
-  GSList *tags = NULL, *tagp = NULL;
-  GtkTextIter iter;
-  gboolean hovering = FALSE;
+  const gchar *p, *end, *valid;
 
-  gtk_text_view_window_to_buffer_coords (GTK_TEXT_VIEW (w), GTK_TEXT_WINDOW_WIDGET, ev->x, ev->y, &x, &y);
+  p = buf;
+  end = buf + len;
+  while (p < end)
+    {
+      gunichar c;
 
-  gtk_text_view_get_iter_at_location (GTK_TEXT_VIEW (w), &iter, x, y);
+      g_utf8_validate (p, end - p, &valid);
+      if (valid > p)
+        stream_output (s, p, valid - p);
+      if (valid == end)
+        break;
 
-  tags = gtk_text_iter_get_tags (&iter);
-  for (tagp = tags; tagp != NULL; tagp = tagp->next)
-    {
-      GtkTextTag *tag = tagp->data;
-      gint link = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (tag), "is_link"));
+      if (end - valid < 4 && g_utf8_get_char_validated (valid, end - valid) == (gunichar) -2)
+        return end - valid;
 
-      if (link)
+      c = (guchar) *valid;
+      if (c >= 0x80)
         {
-          hovering = TRUE;
-          break;
+          gchar ch[2];
+
+          ch[0] = 0xc0 | (c >> 6);
+          ch[1] = 0x80 | (c & 0x3f);
+          stream_output (s, ch, 2);
         }
+      p = valid + 1;
     }
 
-  if (hovering != hovering_over_link)
-    {
-      hovering_over_link = hovering;
+  return 0;
+}
 
-      if (hovering_over_link)
-        gdk_window_set_cursor (gtk_text_view_get_window (GTK_TEXT_VIEW (w), GTK_TEXT_WINDOW_TEXT), hand);
-      else
-        gdk_window_set_cursor (gtk_text_view_get_window (GTK_TEXT_VIEW (w), GTK_TEXT_WINDOW_TEXT), normal);
+/* guess encoding by the first block of data */
+static const gchar *
+detect_encoding (const gchar * buf, gsize len)
+{
+  const gchar *end, *charset;
+  gsize i, n, zeros[2] = { 0, 0 };
+
+  if (len >= 2 && (((guchar) buf[0] == 0xff && (guchar) buf[1] == 0xfe) ||
+                   ((guchar) buf[0] == 0xfe && (guchar) buf[1] == 0xff)))
+    return "UTF-16";
+
+  /* many zero bytes looks like utf-16 without BOM */
+  n = MIN (len, 512);
+  for (i = 0; i < n; i++)
+    {
+      if (buf[i] == '\0')
+        zeros[i % 2]++;
     }
+  if (zeros[1] > n / 8 && zeros[0] == 0)
+    return "UTF-16LE";
+  if (zeros[0] > n / 8 && zeros[1] == 0)
+    return "UTF-16BE";
 
-  if (tags)
-    g_slist_free (tags);
+  if (g_utf8_validate (buf, len, &end) || (len - (end - buf) < 4 &&
+                                           g_utf8_get_char_validated (end, len - (end - buf)) == (gunichar) -2))
+    return NULL;
 
-  return FALSE;
+  /* not a utf-8, so use locale charset if it's not utf-8 too */
+  if (!g_get_charset (&charset))
+    return charset;
+
+  return "ISO-8859-1";
 }
 
 static void
-linkify_cb (GtkTextBuffer * buf, GRegex * regex)
+stream_open_conv (TextStream * s, const gchar * enc)
 {
-  gchar *text;
-  GtkTextIter start, end;
-  GMatchInfo *match;
+  if (enc == NULL || g_ascii_strcasecmp (enc, "UTF-8") == 0 || g_ascii_strcasecmp (enc, "UTF8") == 0)
+    return;
 
-  gtk_text_buffer_get_bounds (buf, &start, &end);
-  text = gtk_text_buffer_get_text (buf, &start, &end, FALSE);
+  s->conv = g_iconv_open ("UTF-8", enc);
+  /* broken data is skipped by code units */
+  if (g_ascii_strncasecmp (enc, "UTF-16", 6) == 0 || g_ascii_strncasecmp (enc, "UTF16", 5) == 0 ||
+      g_ascii_strncasecmp (enc, "UCS-2", 5) == 0 || g_ascii_strncasecmp (enc, "UCS2", 4) == 0)
+    s->unit = 2;
+  else if (g_ascii_strncasecmp (enc, "UTF-32", 6) == 0 || g_ascii_strncasecmp (enc, "UTF32", 5) == 0 ||
+           g_ascii_strncasecmp (enc, "UCS-4", 5) == 0 || g_ascii_strncasecmp (enc, "UCS4", 4) == 0)
+    s->unit = 4;
+  if (s->conv == (GIConv) -1)
+    g_printerr (_("Cannot convert from '%s': %s\n"), enc, g_strerror (errno));
+}
+
+/* feed raw input data to the stream */
+static void
+stream_feed (TextStream * s, const gchar * buf, gsize len)
+{
+  gchar *in;
+  gsize inleft;
 
-  gtk_text_buffer_remove_all_tags (buf, &start, &end);
+  if (s->rest->len > 0)
+    {
+      g_string_append_len (s->rest, buf, len);
+      in = s->rest->str;
+      inleft = s->rest->len;
+    }
+  else
+    {
+      in = (gchar *) buf;
+      inleft = len;
+    }
 
-  if (g_regex_match (regex, text, G_REGEX_MATCH_NOTEMPTY, &match))
+  if (!s->checked)
     {
-      do
+      if (options.text_data.encoding && g_ascii_strcasecmp (options.text_data.encoding, "auto") == 0)
+        stream_open_conv (s, detect_encoding (in, inleft));
+      else
+        stream_open_conv (s, options.text_data.encoding);
+      s->checked = TRUE;
+    }
+
+  if (s->conv == (GIConv) -1)
+    {
+      gsize n = stream_output_utf8 (s, in, inleft);
+
+      in += inleft - n;
+      inleft = n;
+    }
+  else
+    {
+      gchar out[READ_CHUNK];
+
+      while (inleft > 0)
         {
-          gint sp, ep, spos, epos;
+          gchar *outbuf = out;
+          gsize outleft = sizeof (out);
+          gsize res;
 
-          g_match_info_fetch_pos (match, 0, &sp, &ep);
+          res = g_iconv (s->conv, &in, &inleft, &outbuf, &outleft);
+          if (outbuf > out)
+            stream_output (s, out, outbuf - out);
 
-          /* positions are in bytes, not character, so here we must normalize it */
-          spos = g_utf8_pointer_to_offset (text, text + sp);
-          epos = g_utf8_pointer_to_offset (text, text + ep);
+          if (res == (gsize) -1)
+            {
+              if (errno == EILSEQ)
+                {
+                  gsize skip = MIN (s->unit, inleft);
 
-          gtk_text_buffer_get_iter_at_offset (buf, &start, spos);
-          gtk_text_buffer_get_iter_at_offset (buf, &end, epos);
+                  /* replace broken code unit with U+FFFD */
+                  stream_output (s, "\357\277\275", 3);
+                  in += skip;
+                  inleft -= skip;
+                }
+              else if (errno != E2BIG)
+                break;          /* incomplete sequence at the end */
+            }
+        }
+    }
 
-          gtk_text_buffer_apply_tag (buf, tag, &start, &end);
+  /* keep the tail for the next chunk */
+  if (s->rest->len > 0)
+    g_string_erase (s->rest, 0, s->rest->len - inleft);
+  else if (inleft > 0)
+    g_string_append_len (s->rest, in, inleft);
+}
+
+/* output the rest of data at the end of input and free the stream */
+static void
+stream_close (TextStream * s)
+{
+  if (s->conv != (GIConv) -1)
+    {
+      gchar out[64], *outbuf = out;
+      gsize outleft = sizeof (out);
+
+      /* truncated character can't be converted */
+      if (s->rest->len > 0)
+        stream_output (s, "\357\277\275", 3);
+      /* reset shift state */
+      g_iconv (s->conv, NULL, NULL, &outbuf, &outleft);
+      if (outbuf > out)
+        stream_output (s, out, outbuf - out);
+      g_iconv_close (s->conv);
+    }
+  else
+    {
+      gsize i;
+
+      /* bytes of truncated utf-8 character are taken as latin-1 */
+      for (i = 0; i < s->rest->len; i++)
+        {
+          guchar c = s->rest->str[i];
+          gchar ch[2];
+
+          ch[0] = 0xc0 | (c >> 6);
+          ch[1] = 0x80 | (c & 0x3f);
+          stream_output (s, ch, 2);
         }
-      while (g_match_info_next (match, NULL));
     }
-  g_match_info_free (match);
 
-  g_free (text);
+  g_string_free (s->rest, TRUE);
+  g_free (s);
 }
 
 static gboolean
 handle_stdin (GIOChannel * channel, GIOCondition condition, gpointer data)
 {
+  TextStream *s = (TextStream *) data;
+
   if ((condition & G_IO_IN) || (condition & (G_IO_IN | G_IO_HUP)))
     {
-      GString *string;
+      gchar buf[READ_CHUNK];
       GError *err = NULL;
-      gint status;
+      gint status, i = 0;
 
-      string = g_string_new (NULL);
       while (channel->is_readable != TRUE)
         usleep (100);
 
+      /* read all available data, but give a chance to redraw on endless stream */
       do
         {
-          status = g_io_channel_read_line_string (channel, string, NULL, &err);
-          while (gtk_events_pending ())
-            gtk_main_iteration ();
+          gsize n = 0;
+
+          status = g_io_channel_read_chars (channel, buf, sizeof (buf), &n, &err);
+          if (n > 0)
+            stream_feed (s, buf, n);
         }
-      while (status == G_IO_STATUS_AGAIN);
+      while (status == G_IO_STATUS_NORMAL && ++i < 16);
+
+      if (options.common_data.tail)
+        scroll_to_end ();
 
-      if (status != G_IO_STATUS_NORMAL)
+      if (status == G_IO_STATUS_ERROR || status == G_IO_STATUS_EOF)
         {
           if (err)
             {
@@ -292,45 +1360,12 @@ handle_stdin (GIOChannel * channel, GIOCondition condition, gpointer data)
               err = NULL;
             }
           /* stop handling */
+          stream_close (s);
+          if (options.common_data.tail)
+            scroll_to_end ();
           g_io_channel_shutdown (channel, TRUE, NULL);
           return FALSE;
         }
-
-      if (string->str[0] == '\014')
-        {
-          GtkTextIter start, end;
-
-          /* clear text if ^L received */
-          gtk_text_buffer_get_start_iter (GTK_TEXT_BUFFER (text_buffer), &start);
-          gtk_text_buffer_get_end_iter (GTK_TEXT_BUFFER (text_buffer), &end);
-          gtk_text_buffer_delete (GTK_TEXT_BUFFER (text_buffer), &start, &end);
-        }
-      else if (string->len > 0)
-        {
-          GtkTextIter end;
-
-          gtk_text_buffer_get_end_iter (GTK_TEXT_BUFFER (text_buffer), &end);
-
-          if (!g_utf8_validate (string->str, string->len, NULL))
-            {
-              gchar *utftext =
-                g_convert_with_fallback (string->str, string->len, "UTF-8", "ISO-8859-1", NULL, NULL, NULL, NULL);
-              gtk_text_buffer_insert (GTK_TEXT_BUFFER (text_buffer), &end, utftext, -1);
-              g_free (utftext);
-            }
-          else
-            gtk_text_buffer_insert (GTK_TEXT_BUFFER (text_buffer), &end, string->str, string->len);
-
-          if (options.common_data.tail)
-            {
-              while (gtk_events_pending ())
-                gtk_main_iteration ();
-              gtk_text_buffer_get_end_iter (GTK_TEXT_BUFFER (text_buffer), &end);
-              gtk_text_view_scroll_to_iter (GTK_TEXT_VIEW (text_view), &end, 0, FALSE, 0, 0);
-            }
-        }
-
-      g_string_free (string, TRUE);
     }
 
 #ifdef HAVE_SOURCEVIEW
@@ -346,12 +1381,28 @@ handle_stdin (GIOChannel * channel, GIOCondition condition, gpointer data)
 }
 
 static void
-fill_buffer_from_file ()
+set_file_language ()
 {
-  GtkTextIter iter, end;
 #ifdef HAVE_SOURCEVIEW
   GtkSourceLanguage *lang;
+
+  if (options.source_data.lang)
+  {
+    lang = gtk_source_language_manager_get_language (gtk_source_language_manager_get_default (), options.source_data.lang);
+    gtk_source_buffer_set_language (GTK_SOURCE_BUFFER (text_buffer), lang);
+  }
+  else if (options.common_data.uri)
+  {
+    lang = gtk_source_language_manager_guess_language (gtk_source_language_manager_get_default (), options.common_data.uri, NULL);
+    gtk_source_buffer_set_language (GTK_SOURCE_BUFFER (text_buffer), lang);
+  }
 #endif
+}
+
+static void
+fill_buffer_from_file ()
+{
+  GtkTextIter iter, end;
   FILE *f;
   gchar buf[2048];
   gint remaining = 0;
@@ -403,21 +1454,110 @@ fill_buffer_from_file ()
   gtk_text_buffer_get_end_iter (GTK_TEXT_BUFFER (text_buffer), &end);
   gtk_text_buffer_delete (GTK_TEXT_BUFFER (text_buffer), &iter, &end);
   gtk_text_buffer_set_modified (GTK_TEXT_BUFFER (text_buffer), FALSE);
+}
 
-#ifdef HAVE_SOURCEVIEW
-  if (options.source_data.lang)
-  {
-    lang = gtk_source_language_manager_get_language (gtk_source_language_manager_get_default (), options.source_data.lang);
-    gtk_source_buffer_set_language (GTK_SOURCE_BUFFER (text_buffer), lang);
-  }
-  else if (options.common_data.uri)
-  {
-    lang = gtk_source_language_manager_guess_language (gtk_source_language_manager_get_default (), options.common_data.uri, NULL);
-    gtk_source_buffer_set_language (GTK_SOURCE_BUFFER (text_buffer), lang);
-  }
-#endif
+#ifdef HAVE_GIO
+/* following the file */
+static gint follow_fd = -1;
+static off_t follow_offset = 0;
+static TextStream *follow_stream = NULL;
+
+static void
+follow_read ()
+{
+  gchar buf[READ_CHUNK];
+  struct stat st;
+  gssize n;
+  gboolean added = FALSE;
+
+  if (follow_fd < 0)
+    return;
+
+  if (fstat (follow_fd, &st) == 0 && st.st_size < follow_offset)
+    {
+      GtkTextIter start, end;
+
+      /* file was truncated, read it from the beginning */
+      gtk_text_buffer_get_bounds (GTK_TEXT_BUFFER (text_buffer), &start, &end);
+      gtk_text_buffer_delete (GTK_TEXT_BUFFER (text_buffer), &start, &end);
+      follow_offset = 0;
+      stream_reset (follow_stream);
+    }
+
+  while ((n = pread (follow_fd, buf, sizeof (buf), follow_offset)) > 0)
+    {
+      follow_offset += n;
+      stream_feed (follow_stream, buf, n);
+      added = TRUE;
+    }
+
+  if (n < 0)
+    g_printerr (_("Cannot read file '%s': %s\n"), options.common_data.uri, g_strerror (errno));
+
+  if (added && options.common_data.tail)
+    scroll_to_end ();
+}
+
+static void
+follow_open ()
+{
+  struct stat st, fst;
+
+  if (stat (options.common_data.uri, &st) != 0)
+    return;                     /* file is removed, wait for the new one */
+
+  if (follow_fd >= 0)
+    {
+      if (fstat (follow_fd, &fst) == 0 && fst.st_dev == st.st_dev && fst.st_ino == st.st_ino)
+        return;
+      /* file was rotated, take the rest of old file and switch to the new one */
+      follow_read ();
+      close (follow_fd);
+    }
+
+  follow_fd = open (options.common_data.uri, O_RDONLY);
+  if (follow_fd < 0)
+    g_printerr (_("Cannot open file '%s': %s\n"), options.common_data.uri, g_strerror (errno));
+  follow_offset = 0;
+  stream_reset (follow_stream);
 }
 
+static void
+follow_changed_cb (GFileMonitor * mon, GFile * file, GFile * ofile, GFileMonitorEvent ev, gpointer data)
+{
+  follow_open ();
+  follow_read ();
+}
+
+static void
+follow_file ()
+{
+  GFile *file;
+  GFileMonitor *mon;
+  GError *err = NULL;
+
+  follow_stream = stream_new (FALSE);
+  follow_open ();
+  follow_read ();
+  gtk_text_buffer_set_modified (GTK_TEXT_BUFFER (text_buffer), FALSE);
+
+  file = g_file_new_for_path (options.common_data.uri);
+  mon = g_file_monitor_file (file, G_FILE_MONITOR_NONE, NULL, &err);
+  if (mon)
+    {
+      /* don't delay changes */
+      g_file_monitor_set_rate_limit (mon, 0);
+      g_signal_connect (G_OBJECT (mon), "changed", G_CALLBACK (follow_changed_cb), NULL);
+    }
+  else
+    {
+      g_printerr (_("Cannot watch file '%s': %s\n"), options.common_data.uri, err->message);
+      g_error_free (err);
+    }
+  g_object_unref (file);
+}
+#endif
+
 static void
 fill_buffer_from_stdin ()
 {
@@ -426,7 +1566,7 @@ fill_buffer_from_stdin ()
   channel = g_io_channel_unix_new (0);
   g_io_channel_set_encoding (channel, NULL, NULL);
   g_io_channel_set_flags (channel, G_IO_FLAG_NONBLOCK, NULL);
-  g_io_add_watch (channel, G_IO_IN | G_IO_HUP, handle_stdin, NULL);
+  g_io_add_watch (channel, G_IO_IN | G_IO_HUP, handle_stdin, stream_new (TRUE));
 }
 
 GtkWidget *
@@ -566,6 +1706,18 @@ text_create_widget (GtkWidget * dlg)
   /* Add submit on ctrl+enter */
   g_signal_connect (text_view, "key-press-event", G_CALLBACK (key_press_cb), dlg);
 
+  /* Initialize searching */
+  search_matches = g_array_new (FALSE, FALSE, sizeof (SearchMatch));
+  search_tag = gtk_text_buffer_create_tag (GTK_TEXT_BUFFER (text_buffer), NULL, "background", "yellow", NULL);
+  g_signal_connect (G_OBJECT (text_buffer), "insert-text", G_CALLBACK (buffer_insert_cb), NULL);
+  g_signal_connect (G_OBJECT (text_buffer), "delete-range", G_CALLBACK (buffer_delete_cb), NULL);
+
+  if (options.text_data.ansi)
+    {
+      ansi_tags = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+      ansi_pending = g_string_new (NULL);
+    }
+
   /* Initialize linkifying */
   if (options.text_data.uri)
     {
@@ -593,7 +1745,17 @@ text_create_widget (GtkWidget * dlg)
   gtk_container_add (GTK_CONTAINER (w), text_view);
 
   if (options.common_data.uri)
-    fill_buffer_from_file ();
+    {
+#ifdef HAVE_GIO
+      if (options.text_data.follow)
+        follow_file ();
+      else
+        fill_buffer_from_file ();
+#else
+      fill_buffer_from_file ();
+#endif
+      set_file_language ();
+    }
 
   if (options.common_data.listen || options.common_data.uri == NULL)
     fill_buffer_from_stdin ();
@@ -613,13 +1775,22 @@ void
 text_print_result (void)
 {
   GtkTextIter start, end;
-  gchar *text;
 
   if (!options.common_data.editable)
     return;
 
-  gtk_text_buffer_get_bounds (GTK_TEXT_BUFFER (text_buffer), &start, &end);
-  text = gtk_text_buffer_get_text (GTK_TEXT_BUFFER (text_buffer), &start, &end, 0);
-  g_print ("%s", text);
-  g_free (text);
+  /* output text by small pieces instead of copying the whole buffer */
+  gtk_text_buffer_get_start_iter (GTK_TEXT_BUFFER (text_buffer), &start);
+  while (!gtk_text_iter_is_end (&start))
+    {
+      gchar *text;
+
+      end = start;
+      gtk_text_iter_forward_chars (&end, PRINT_CHUNK);
+      text = gtk_text_iter_get_visible_text (&start, &end);
+      fwrite (text, 1, strlen (text), stdout);
+      g_free (text);
+      start = end;
+    }
+  fflush (stdout);
 }
@@ -583,63 +583,234 @@ escape_char (gchar *str, gchar ch)
   return res;
 }
 
-gboolean
-check_complete (GtkEntryCompletion *c, const gchar *key, GtkTreeIter *iter, gpointer data)
+/* completion index. keeps casefolded values and matches of the current key,
+ * so the match function is called for each row but does only a lookup */
+#define COMPLETION_CACHE_SIZE 64
+
+typedef struct {
+  YadCompletionType type;
+  GPtrArray *keys;              /* casefolded values by row id */
+  gchar *key;                   /* current key */
+  GArray *matches;              /* row ids matched by current key */
+  guint8 *mask;
+  guint mask_size;
+  GHashTable *cache;            /* key => matched row ids */
+} YadCompletionIndex;
+
+static void
+completion_index_free (YadCompletionIndex *idx)
 {
-  gchar *value = NULL;
-  GtkTreeModel *model = gtk_entry_completion_get_model (c);
-  gboolean found = FALSE;
+  g_ptr_array_free (idx->keys, TRUE);
+  g_free (idx->key);
+  g_free (idx->mask);
+  g_hash_table_destroy (idx->cache);
+  g_free (idx);
+}
 
-  if (!model || !key || !key[0])
-    return FALSE;
+/* forget all results */
+static void
+completion_index_reset (YadCompletionIndex *idx)
+{
+  g_free (idx->key);
+  idx->key = NULL;
+  idx->matches = NULL;
+  g_hash_table_remove_all (idx->cache);
+}
+
+GtkTreeModel *
+completion_model_new (void)
+{
+  GtkListStore *store;
+  YadCompletionIndex *idx;
+
+  store = gtk_list_store_new (2, G_TYPE_STRING, G_TYPE_UINT);
+
+  idx = g_new0 (YadCompletionIndex, 1);
+  idx->type = options.common_data.complete;
+  idx->keys = g_ptr_array_new_with_free_func (g_free);
+  idx->cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_array_unref);
+  g_object_set_data_full (G_OBJECT (store), "yad-completion-index", idx, (GDestroyNotify) completion_index_free);
+
+  return GTK_TREE_MODEL (store);
+}
+
+void
+completion_model_add (GtkTreeModel *model, const gchar *text)
+{
+  YadCompletionIndex *idx = g_object_get_data (G_OBJECT (model), "yad-completion-index");
+  gchar *norm;
+
+  gtk_list_store_insert_with_values (GTK_LIST_STORE (model), NULL, -1, 0, text, 1, idx->keys->len, -1);
+
+  norm = g_utf8_normalize (text, -1, G_NORMALIZE_ALL);
+  g_ptr_array_add (idx->keys, g_utf8_casefold (norm ? norm : text, -1));
+  g_free (norm);
 
-  gtk_tree_model_get (model, iter, 0, &value, -1);
+  if (idx->key)
+    completion_index_reset (idx);
+}
+
+/* set match mode different from --complete */
+void
+completion_model_set_type (GtkTreeModel *model, YadCompletionType type)
+{
+  YadCompletionIndex *idx = g_object_get_data (G_OBJECT (model), "yad-completion-index");
+
+  idx->type = type;
+  completion_index_reset (idx);
+}
 
-  if (value)
+void
+completion_model_clear (GtkTreeModel *model)
+{
+  YadCompletionIndex *idx = g_object_get_data (G_OBJECT (model), "yad-completion-index");
+
+  gtk_list_store_clear (GTK_LIST_STORE (model));
+  g_ptr_array_set_size (idx->keys, 0);
+  completion_index_reset (idx);
+}
+
+/* search rows matched by key. if from is set only these rows are checked */
+static GArray *
+completion_find (YadCompletionIndex *idx, const gchar *key, GArray *from)
+{
+  GArray *res;
+  GRegex *regex = NULL;
+  gchar **words = NULL;
+  guint i, n;
+
+  res = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  if (idx->type == YAD_COMPLETE_REGEX)
+    {
+      /* compile once per key */
+      regex = g_regex_new (key, G_REGEX_CASELESS | G_REGEX_OPTIMIZE, G_REGEX_MATCH_NOTEMPTY, NULL);
+      if (!regex)
+        return res;
+    }
+  else
+    words = g_strsplit_set (key, " \t", -1);
+
+  n = from ? from->len : idx->keys->len;
+  for (i = 0; i < n; i++)
     {
-      gchar **words = NULL;
-      guint i = 0;
+      guint id = from ? g_array_index (from, guint, i) : i;
+      gchar *value = g_ptr_array_index (idx->keys, id);
+      gboolean found = FALSE;
+      guint j;
 
-      switch (options.common_data.complete)
+      switch (idx->type)
         {
+        case YAD_COMPLETE_SIMPLE:
+          found = g_str_has_prefix (value, key);
+          break;
         case YAD_COMPLETE_ANY:
-          words = g_strsplit_set (key, " \t", -1);
-          while (words[i])
-            {
-              if (strcasestr (value, words[i]) != NULL)
-                {
-                  /* found one of the words */
-                  found = TRUE;
-                  break;
-                }
-              i++;
-            }
+          for (j = 0; words[j] && !found; j++)
+            found = (strstr (value, words[j]) != NULL);
           break;
         case YAD_COMPLETE_ALL:
-          words = g_strsplit_set (key, " \t", -1);
           found = TRUE;
-          while (words[i])
-            {
-              if (strcasestr (value, words[i]) == NULL)
-                {
-                  /* not found one of the words */
-                  found = FALSE;
-                  break;
-                }
-              i++;
-            }
+          for (j = 0; words[j] && found; j++)
+            found = (strstr (value, words[j]) != NULL);
           break;
         case YAD_COMPLETE_REGEX:
-          found = g_regex_match_simple (key, value, G_REGEX_CASELESS | G_REGEX_OPTIMIZE, G_REGEX_MATCH_NOTEMPTY);
+          found = g_regex_match (regex, value, 0, NULL);
           break;
         default: ;
         }
 
-      if (words)
-        g_strfreev (words);
+      if (found)
+        g_array_append_val (res, id);
     }
 
-  return found;
+  if (regex)
+    g_regex_unref (regex);
+  g_strfreev (words);
+
+  return res;
+}
+
+static void
+completion_set_key (YadCompletionIndex *idx, const gchar *key)
+{
+  GArray *res;
+  guint i;
+
+  res = g_hash_table_lookup (idx->cache, key);
+  if (!res)
+    {
+      GArray *from = NULL;
+
+      /* when the key grows, only previous matches must be checked */
+      if (idx->key && idx->matches && g_str_has_prefix (key, idx->key))
+        {
+          if (idx->type == YAD_COMPLETE_SIMPLE ||
+              idx->type == YAD_COMPLETE_ALL)
+            from = idx->matches;
+          else if (idx->type == YAD_COMPLETE_ANY &&
+                   strpbrk (key + strlen (idx->key), " \t") == NULL)
+            from = idx->matches;
+        }
+
+      res = completion_find (idx, key, from);
+
+      if (g_hash_table_size (idx->cache) >= COMPLETION_CACHE_SIZE)
+        {
+          g_hash_table_remove_all (idx->cache);
+          idx->matches = NULL;
+        }
+      g_hash_table_insert (idx->cache, g_strdup (key), res);
+    }
+
+  /* update matches map */
+  if (idx->mask_size != idx->keys->len)
+    {
+      g_free (idx->mask);
+      idx->mask_size = idx->keys->len;
+      idx->mask = g_new0 (guint8, idx->mask_size);
+    }
+  else if (idx->matches)
+    {
+      for (i = 0; i < idx->matches->len; i++)
+        idx->mask[g_array_index (idx->matches, guint, i)] = 0;
+    }
+  else
+    memset (idx->mask, 0, idx->mask_size);
+
+  for (i = 0; i < res->len; i++)
+    idx->mask[g_array_index (res, guint, i)] = 1;
+
+  g_free (idx->key);
+  idx->key = g_strdup (key);
+  idx->matches = res;
+}
+
+/* key must be normalized and casefolded */
+gboolean
+completion_model_match (GtkTreeModel *model, const gchar *key, GtkTreeIter *iter)
+{
+  YadCompletionIndex *idx;
+  guint id;
+
+  if (!model || !key || !key[0])
+    return FALSE;
+
+  idx = g_object_get_data (G_OBJECT (model), "yad-completion-index");
+  if (!idx)
+    return FALSE;
+
+  if (g_strcmp0 (key, idx->key) != 0)
+    completion_set_key (idx, key);
+
+  gtk_tree_model_get (model, iter, 1, &id, -1);
+
+  return id < idx->mask_size && idx->mask[id];
+}
+
+gboolean
+check_complete (GtkEntryCompletion *c, const gchar *key, GtkTreeIter *iter, gpointer data)
+{
+  return completion_model_match (gtk_entry_completion_get_model (c), key, iter);
 }
 
 void
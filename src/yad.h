@@ -179,6 +179,12 @@ typedef enum {
   YAD_COMPLETE_REGEX
 } YadCompletionType;
 
+typedef enum {
+  YAD_SEARCH_REGEX = 0,
+  YAD_SEARCH_LITERAL,
+  YAD_SEARCH_CASELESS
+} YadSearchType;
+
 typedef enum {
   YAD_BOOL_FMT_UT,
   YAD_BOOL_FMT_UY,
@@ -296,6 +302,8 @@ typedef struct {
   gchar *entry_text;
   gchar *entry_label;
   gboolean completion;
+  gchar *completion_file;
+  gchar *completion_cmd;
   gboolean numeric;
   gchar *licon;
   gchar *licon_action;
@@ -321,10 +329,10 @@ typedef struct {
 typedef struct {
   GSList *fields;
   guint columns;
-  gboolean scroll;
   gboolean output_by_row;
   guint focus_field;
   gboolean cycle_read;
+  gboolean keyed_input;
   gboolean align_buttons;
   gchar *changed_action;
   gboolean homogeneous;
@@ -439,6 +447,12 @@ typedef struct {
   gboolean log_expanded;
   gboolean log_on_top;
   gint log_height;
+  gint log_lines;
+  gboolean eta;
+  gboolean pipe;
+  guint64 pipe_size;
+  gchar *socket;
+  gchar *fifo;
 } YadProgressData;
 
 typedef struct {
@@ -465,6 +479,12 @@ typedef struct {
   gboolean uri;
   gboolean hide_cursor;
   gchar *uri_color;
+  YadSearchType search_type;
+  gboolean ansi;
+  gchar *encoding;
+#ifdef HAVE_GIO
+  gboolean follow;
+#endif
 } YadTextData;
 
 #ifdef HAVE_SOURCEVIEW
@@ -494,6 +514,7 @@ typedef struct {
   gboolean quoted_output;
   gboolean num_output;
   gboolean hide_text;
+  gboolean scroll;
   gint icon_size;
 #if GLIB_CHECK_VERSION(2,30,0)
   GFormatSizeFlags size_fmt;
@@ -624,6 +645,7 @@ gboolean file_confirm_overwrite (GtkWidget *dlg);
 void notebook_swallow_childs (void);
 void paned_swallow_childs (void);
 void picture_fit_to_window (void);
+void progress_print_stats (void);
 
 void calendar_print_result (void);
 void color_print_result (void);
@@ -671,6 +693,11 @@ GtkWidget *get_label (gchar *str, guint border, GtkWidget *w);
 gchar *escape_str (gchar *str);
 gchar *escape_char (gchar *str, gchar ch);
 
+GtkTreeModel *completion_model_new (void);
+void completion_model_add (GtkTreeModel *model, const gchar *text);
+void completion_model_set_type (GtkTreeModel *model, YadCompletionType type);
+void completion_model_clear (GtkTreeModel *model);
+gboolean completion_model_match (GtkTreeModel *model, const gchar *key, GtkTreeIter *iter);
 gboolean check_complete (GtkEntryCompletion *c, const gchar *key, GtkTreeIter *iter, gpointer data);
 
 void parse_geometry ();